@@ -0,0 +1,113 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 15:50:44
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 15:50:44
+ */
+
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include "Mutex.h"
+#include "Noncopyable.h"
+
+namespace East {
+
+class Timer;
+
+/**
+ * @brief 取消令牌
+ *
+ * 一个请求对应一个令牌，处理这个请求的协程通过SetThis绑定令牌，派生出去的任务用Bind包一层，
+ * 在子令牌下执行。cancel之后：
+ * - 绑定了令牌的协程阻塞在hook的IO(recv/send/accept/connect...)上时立刻被唤醒，返回-1，errno为ECANCELED
+ * - 阻塞在hook的sleep/usleep/nanosleep上时取消定时器并立刻返回
+ * - 之后再发起的阻塞IO直接返回ECANCELED
+ * - 所有子令牌一起取消
+ *
+ * @code
+ * auto token = East::CancellationToken::Create();
+ * token->cancelAfter(200);  //请求的截止时间
+ * iom->schedule(token->bind([]() { handle_request(); }));
+ * @endcode
+ */
+class CancellationToken : public std::enable_shared_from_this<CancellationToken>,
+                          private noncopymoveable {
+ public:
+  using sptr = std::shared_ptr<CancellationToken>;
+
+  /**
+   * @brief 创建一个没有父令牌的令牌
+   */
+  static sptr Create();
+
+  ~CancellationToken();
+
+  /**
+   * @brief 创建子令牌，自己被取消时子令牌一起取消，子令牌取消不影响自己
+   */
+  sptr createChild();
+
+  /**
+   * @brief 取消，执行所有回调并取消子令牌，只有第一次调用生效
+   */
+  void cancel();
+
+  bool isCancelled() const { return m_cancelled.load(std::memory_order_acquire); }
+
+  /**
+   * @brief ms毫秒后自动取消，需要在IOManager中调用
+   */
+  void cancelAfter(uint64_t ms);
+
+  /**
+   * @brief 注册取消时执行的回调
+   * @return 回调id，已经取消的话在当前执行流直接执行cb并返回0
+   *
+   * 回调在调用cancel的执行流中执行，不能阻塞。
+   */
+  uint64_t addCallback(std::function<void()> cb);
+
+  /**
+   * @brief 注销回调，回调可能已经在执行或者执行完了
+   */
+  void removeCallback(uint64_t id);
+
+  /**
+   * @brief 把cb包装成在子令牌下执行的任务，用于派生子任务
+   */
+  std::function<void()> bind(std::function<void()> cb);
+
+ public:
+  /**
+   * @brief 当前协程绑定的令牌，没有绑定返回nullptr
+   */
+  static sptr GetThis();
+
+  /**
+   * @brief 给当前协程绑定令牌，协程结束时自动解绑
+   */
+  static void SetThis(sptr token);
+
+  /**
+   * @brief 把cb包装成在当前协程令牌的子令牌下执行的任务，当前协程没有令牌时原样返回
+   */
+  static std::function<void()> Bind(std::function<void()> cb);
+
+ private:
+  CancellationToken() {}
+
+ private:
+  std::atomic<bool> m_cancelled{false};  ///< 是否已经取消
+  SpinLock m_mutex;                      ///< 保护回调和定时器
+  uint64_t m_nextId{1};                  ///< 下一个回调id
+  std::map<uint64_t, std::function<void()>> m_callbacks;  ///< 取消时执行的回调
+  sptr m_parent;                   ///< 父令牌
+  uint64_t m_parentCallbackId{0};  ///< 在父令牌上注册的回调id
+  std::shared_ptr<Timer> m_timer;  ///< cancelAfter的定时器
+};
+
+}  // namespace East
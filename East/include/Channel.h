@@ -0,0 +1,349 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 14:30:08
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 14:30:08
+ */
+
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "Fiber.h"
+#include "FiberSync.h"
+#include "Mutex.h"
+#include "Noncopyable.h"
+
+namespace East {
+
+class ChannelBase;
+
+/**
+ * @brief 一次阻塞的send/recv/Select，所有case共享
+ *
+ * 对端、close和超时定时器通过CAS抢完成权，只有抢到的一方写入结果并唤醒等待者。
+ */
+struct ChannelWaiter {
+  using sptr = std::shared_ptr<ChannelWaiter>;
+
+  static constexpr int kWaiting = -1;  ///< 还在等待
+  static constexpr int kTimeout = -2;  ///< 超时
+
+  std::atomic<int> fired{kWaiting};  ///< 完成的case下标
+  Fiber::WaitNode* node{nullptr};    ///< 挂起的执行流
+
+  /**
+   * @brief 抢完成权
+   * @param index 完成的case下标或kTimeout
+   * @return 抢到返回true，调用者负责唤醒
+   */
+  bool tryFire(int index) {
+    int expected = kWaiting;
+    return fired.compare_exchange_strong(expected, index,
+                                         std::memory_order_acq_rel);
+  }
+};
+
+/**
+ * @brief Select中的一个case
+ *
+ * 放在堆上，挂起期间对端直接读写其中的值：共享栈协程挂起后栈内容会被换出，不能让对端写栈。
+ * 每个case只能用于一次Select。
+ */
+struct ChannelOp {
+  using sptr = std::shared_ptr<ChannelOp>;
+
+  virtual ~ChannelOp() {}
+
+  /**
+   * @brief 在调用者自己的执行流中把收到的值和结果交给调用者
+   */
+  virtual void finish() = 0;
+
+  ChannelBase* channel{nullptr};  ///< 所属的通道
+  bool is_send{false};            ///< 发送还是接收
+  int index{0};                   ///< 在Select中的下标
+  bool ok{false};                 ///< 是否成功，通道关闭时为false
+  bool* ok_out{nullptr};          ///< 调用者接收ok的位置，可以为空
+  ChannelWaiter::sptr waiter;     ///< 挂在等待队列上时所属的等待
+};
+
+template <class T>
+struct TypedChannelOp : public ChannelOp {
+  std::optional<T> value;  ///< 要发送的值或收到的值
+  T* out{nullptr};         ///< 调用者接收值的位置
+
+  void finish() override {
+    if (ok && nullptr != out && value) {
+      *out = std::move(*value);
+    }
+    if (nullptr != ok_out) {
+      *ok_out = ok;
+    }
+  }
+};
+
+/**
+ * @brief 在多个通道操作中等待第一个完成的
+ * @param cases Channel::sendCase/recvCase创建的case
+ * @param timeout_ms 超时时间，-1表示一直等待，0表示不等待；
+ *        超时需要在IOManager中调用，定时器来自IOManager::GetThis()
+ * @return 完成的case下标，超时返回-1。通道已关闭的case也算完成，ok为false
+ *
+ * 多个case同时就绪时选下标最小的。
+ */
+int Select(const std::vector<ChannelOp::sptr>& cases, int64_t timeout_ms = -1);
+
+/**
+ * @brief 通道的公共部分：锁、关闭状态和等待队列
+ *
+ * 缓冲区不为空时不会有接收者等待，缓冲区不满时不会有发送者等待，
+ * 所以发送时如果有接收者在等，值直接交给接收者并唤醒它，接收者醒来时已经拿到值，不需要重新加锁竞争，
+ * 值也不经过缓冲区多拷贝一次。唤醒仍然是通过Scheduler::schedule把接收者放回调度队列，
+ * 不是从发送者直接切换过去。
+ */
+class ChannelBase : private noncopymoveable {
+  friend int Select(const std::vector<ChannelOp::sptr>& cases,
+                    int64_t timeout_ms);
+
+ public:
+  virtual ~ChannelBase() {}
+
+  /**
+   * @brief 关闭通道，唤醒所有等待者
+   *
+   * 关闭后send返回false，recv取完缓冲区中剩余的值后返回false。
+   */
+  void close();
+
+  bool isClosed() {
+    SpinLock::LockGuard lock(m_lock);
+    return m_closed;
+  }
+
+ protected:
+  /**
+   * @brief 不挂起地完成op，持有m_lock时调用
+   * @param op 本通道上的case
+   * @param[out] wake 需要唤醒的对端，释放锁之后唤醒
+   * @return 完成了返回true
+   */
+  virtual bool tryOpLocked(ChannelOp* op, ChannelWaiter::sptr& wake) = 0;
+
+  /**
+   * @brief 从等待队列中取出一个还在等待的op并抢到完成权，已经被其他通道完成的op直接丢弃
+   */
+  static ChannelOp::sptr PopWaiterLocked(std::deque<ChannelOp::sptr>& q);
+
+  /**
+   * @brief 唤醒对端
+   */
+  static void Wake(const ChannelWaiter::sptr& waiter) {
+    if (nullptr != waiter) {
+      FiberParker::Wake(waiter->node);
+    }
+  }
+
+ private:
+  //按地址从小到大锁住所有通道，chans已经排序去重
+  static void LockAll(const std::vector<ChannelBase*>& chans);
+  static void UnlockAll(const std::vector<ChannelBase*>& chans);
+  void enqueueLocked(const ChannelOp::sptr& op);
+  void removeLocked(const ChannelWaiter* waiter);
+
+ protected:
+  SpinLock m_lock;                      ///< 保护通道的所有状态
+  bool m_closed{false};                 ///< 是否已关闭
+  std::deque<ChannelOp::sptr> m_sendq;  ///< 等待发送的op
+  std::deque<ChannelOp::sptr> m_recvq;  ///< 等待接收的op
+};
+
+/**
+ * @brief 协程间传递T的通道
+ *
+ * capacity为0时是无缓冲通道，发送方要等到接收方取走才返回。
+ * send/recv会挂起当前协程，可以跨IOManager的线程，也可以跨不同的Scheduler使用。
+ *
+ * @code
+ * East::Channel<int> ch(16);
+ * iom.schedule([&]() { for (int i = 0; i < 100; ++i) ch.send(i); ch.close(); });
+ * int v;
+ * while (ch.recv(v)) { ... }
+ * @endcode
+ */
+template <class T>
+class Channel : public ChannelBase {
+ public:
+  using sptr = std::shared_ptr<Channel>;
+
+  /**
+   * @brief 构造函数
+   * @param capacity 缓冲区大小，0表示无缓冲
+   */
+  explicit Channel(size_t capacity = 0) : m_capacity(capacity) {}
+
+  /**
+   * @brief 发送，缓冲区满时挂起
+   * @param v 要发送的值
+   * @param timeout_ms 超时时间，-1表示一直等待，0表示不等待
+   * @return 通道已关闭或者超时返回false
+   */
+  bool send(T v, int64_t timeout_ms = -1) {
+    ChannelWaiter::sptr wake;
+    bool ok = false;
+    {
+      SpinLock::LockGuard lock(m_lock);
+      if (trySendLocked(v, wake, ok)) {
+        lock.unlock();
+        Wake(wake);
+        return ok;
+      }
+    }
+    if (0 == timeout_ms) {
+      return false;
+    }
+    bool sent = false;
+    return 0 == Select({sendCase(std::move(v), &sent)}, timeout_ms) && sent;
+  }
+
+  /**
+   * @brief 接收，没有数据时挂起
+   * @param[out] out 收到的值
+   * @param timeout_ms 超时时间，-1表示一直等待，0表示不等待
+   * @return 通道已关闭且缓冲区为空或者超时返回false
+   */
+  bool recv(T& out, int64_t timeout_ms = -1) {
+    ChannelWaiter::sptr wake;
+    std::optional<T> value;
+    bool ok = false;
+    {
+      SpinLock::LockGuard lock(m_lock);
+      if (tryRecvLocked(value, wake, ok)) {
+        lock.unlock();
+        Wake(wake);
+        if (ok) {
+          out = std::move(*value);
+        }
+        return ok;
+      }
+    }
+    if (0 == timeout_ms) {
+      return false;
+    }
+    bool received = false;
+    return 0 == Select({recvCase(&out, &received)}, timeout_ms) && received;
+  }
+
+  /**
+   * @brief 创建Select用的发送case
+   * @param v 要发送的值
+   * @param ok 可以为空，完成后写入是否发送成功
+   */
+  ChannelOp::sptr sendCase(T v, bool* ok = nullptr) {
+    auto op = std::make_shared<TypedChannelOp<T>>();
+    op->channel = this;
+    op->is_send = true;
+    op->ok_out = ok;
+    op->value.emplace(std::move(v));
+    return op;
+  }
+
+  /**
+   * @brief 创建Select用的接收case
+   * @param out 收到的值写到这里
+   * @param ok 可以为空，完成后写入是否收到了值，通道关闭时为false
+   */
+  ChannelOp::sptr recvCase(T* out, bool* ok = nullptr) {
+    auto op = std::make_shared<TypedChannelOp<T>>();
+    op->channel = this;
+    op->is_send = false;
+    op->ok_out = ok;
+    op->out = out;
+    return op;
+  }
+
+  /**
+   * @brief 缓冲区中的元素个数
+   */
+  size_t size() {
+    SpinLock::LockGuard lock(m_lock);
+    return m_buffer.size();
+  }
+
+  size_t capacity() const { return m_capacity; }
+
+ protected:
+  bool tryOpLocked(ChannelOp* op, ChannelWaiter::sptr& wake) override {
+    auto t = static_cast<TypedChannelOp<T>*>(op);
+    if (op->is_send) {
+      return trySendLocked(*t->value, wake, op->ok);
+    }
+    return tryRecvLocked(t->value, wake, op->ok);
+  }
+
+ private:
+  bool trySendLocked(T& v, ChannelWaiter::sptr& wake, bool& ok) {
+    if (m_closed) {
+      ok = false;
+      return true;
+    }
+    //有接收者在等，直接交给它
+    ChannelOp::sptr r = PopWaiterLocked(m_recvq);
+    if (nullptr != r) {
+      auto t = static_cast<TypedChannelOp<T>*>(r.get());
+      t->value.emplace(std::move(v));
+      t->ok = true;
+      wake = r->waiter;
+      ok = true;
+      return true;
+    }
+    if (m_buffer.size() < m_capacity) {
+      m_buffer.push_back(std::move(v));
+      ok = true;
+      return true;
+    }
+    return false;
+  }
+
+  bool tryRecvLocked(std::optional<T>& out, ChannelWaiter::sptr& wake,
+                     bool& ok) {
+    if (!m_buffer.empty()) {
+      out.emplace(std::move(m_buffer.front()));
+      m_buffer.pop_front();
+      //空出一个位置，把等待最久的发送者的值放进缓冲区
+      ChannelOp::sptr s = PopWaiterLocked(m_sendq);
+      if (nullptr != s) {
+        auto t = static_cast<TypedChannelOp<T>*>(s.get());
+        m_buffer.push_back(std::move(*t->value));
+        t->ok = true;
+        wake = s->waiter;
+      }
+      ok = true;
+      return true;
+    }
+    //无缓冲通道直接从发送者手里拿
+    ChannelOp::sptr s = PopWaiterLocked(m_sendq);
+    if (nullptr != s) {
+      auto t = static_cast<TypedChannelOp<T>*>(s.get());
+      out.emplace(std::move(*t->value));
+      t->ok = true;
+      wake = s->waiter;
+      ok = true;
+      return true;
+    }
+    if (m_closed) {
+      ok = false;
+      return true;
+    }
+    return false;
+  }
+
+ private:
+  size_t m_capacity;       ///< 缓冲区大小
+  std::deque<T> m_buffer;  ///< 缓冲区
+};
+
+}  // namespace East
@@ -0,0 +1,370 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 16:58:27
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 16:58:27
+ */
+
+#pragma once
+
+#if __cplusplus < 202002L || !defined(__cpp_impl_coroutine)
+#error "Coroutine.h needs C++20 coroutines, build with -DEAST_COROUTINE=ON"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include "Future.h"
+#include "IOManager.h"
+#include "Noncopyable.h"
+
+/**
+ * C++20无栈协程
+ *
+ * 只有头文件，库本身仍然按C++17编译，用到的都是IOManager/Scheduler/Timer的公开接口。
+ * 协程每次恢复都作为一个函数任务交给调度器，在工作线程的回调协程里执行，
+ * 所以和有栈协程共用同样的工作线程，协程里也可以调用hook的阻塞接口和Fiber同步原语。
+ *
+ * @code
+ * East::Task<size_t> echo(int fd) {
+ *   char buf[128];
+ *   if (!co_await East::WaitEvent(fd, East::IOManager::READ, 1000)) {
+ *     co_return 0;
+ *   }
+ *   co_return read(fd, buf, sizeof(buf));
+ * }
+ * East::Future<size_t> f = East::Spawn(iom, echo(fd));
+ * @endcode
+ */
+
+namespace East {
+
+template <class T = void>
+class Task;
+
+namespace detail {
+
+/**
+ * @brief 协程结束时切回等待它的协程
+ */
+struct TaskFinalAwaiter {
+  bool await_ready() const noexcept { return false; }
+
+  template <class P>
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+    std::coroutine_handle<> cont = h.promise().m_continuation;
+    return cont ? cont : std::noop_coroutine();
+  }
+
+  void await_resume() const noexcept {}
+};
+
+struct TaskPromiseBase {
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+
+  TaskFinalAwaiter final_suspend() const noexcept { return {}; }
+
+  void unhandled_exception() { m_exception = std::current_exception(); }
+
+  void rethrowIfFailed() const {
+    if (m_exception) {
+      std::rethrow_exception(m_exception);
+    }
+  }
+
+  std::coroutine_handle<> m_continuation;  ///< co_await这个任务的协程
+  std::exception_ptr m_exception;          ///< 协程抛出的异常
+};
+
+template <class T>
+struct TaskPromise : public TaskPromiseBase {
+  Task<T> get_return_object();
+
+  template <class U>
+  void return_value(U&& v) {
+    m_value.emplace(std::forward<U>(v));
+  }
+
+  T result() {
+    rethrowIfFailed();
+    return std::move(*m_value);
+  }
+
+  std::optional<T> m_value;  ///< co_return的值
+};
+
+template <>
+struct TaskPromise<void> : public TaskPromiseBase {
+  Task<void> get_return_object();
+
+  void return_void() const noexcept {}
+
+  void result() const { rethrowIfFailed(); }
+};
+
+}  // namespace detail
+
+/**
+ * @brief 惰性启动的协程任务
+ *
+ * 创建后不执行，被co_await或者交给Spawn时才开始执行，
+ * co_await得到co_return的值，协程抛出的异常在co_await处重新抛出。
+ */
+template <class T>
+class Task : private noncopyable {
+ public:
+  using promise_type = detail::TaskPromise<T>;
+  using Handle = std::coroutine_handle<promise_type>;
+
+  Task() {}
+  explicit Task(Handle h) : m_handle(h) {}
+
+  Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      if (m_handle) {
+        m_handle.destroy();
+      }
+      m_handle = std::exchange(other.m_handle, {});
+    }
+    return *this;
+  }
+
+  ~Task() {
+    if (m_handle) {
+      m_handle.destroy();
+    }
+  }
+
+  bool valid() const { return static_cast<bool>(m_handle); }
+
+  auto operator co_await() const noexcept {
+    struct Awaiter {
+      Handle handle;
+
+      bool await_ready() const noexcept { return !handle || handle.done(); }
+
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> cont) {
+        handle.promise().m_continuation = cont;
+        return handle;
+      }
+
+      decltype(auto) await_resume() { return handle.promise().result(); }
+    };
+    return Awaiter{m_handle};
+  }
+
+ private:
+  Handle m_handle;  ///< 协程句柄，Task销毁时销毁协程帧
+};
+
+namespace detail {
+
+template <class T>
+inline Task<T> TaskPromise<T>::get_return_object() {
+  return Task<T>(Task<T>::Handle::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+  return Task<void>(Task<void>::Handle::from_promise(*this));
+}
+
+/**
+ * @brief 立即执行、执行完自己销毁的协程，用来驱动Spawn的任务
+ */
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() const noexcept { return {}; }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+};
+
+template <class T>
+DetachedTask RunTask(Task<T> task, std::shared_ptr<Promise<T>> promise) {
+  try {
+    if constexpr (std::is_void<T>::value) {
+      co_await task;
+      promise->setValue();
+    } else {
+      promise->setValue(co_await task);
+    }
+  } catch (...) {
+    promise->setException(std::current_exception());
+  }
+}
+
+/**
+ * @brief 恢复协程，在调度器中时交给调度器，否则在当前线程直接恢复
+ */
+inline void ResumeOn(Scheduler* scheduler, std::coroutine_handle<> h,
+                     int thread_id = -1) {
+  if (nullptr != scheduler) {
+    scheduler->schedule([h]() { h.resume(); }, thread_id);
+  } else {
+    h.resume();
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief 在调度器中启动协程任务
+ * @param scheduler 执行任务的调度器
+ * @param task 协程任务
+ * @return 任务的结果，协程里可以co_await，有栈协程里可以get
+ */
+template <class T>
+Future<T> Spawn(Scheduler* scheduler, Task<T> task) {
+  auto promise = std::make_shared<Promise<T>>();
+  Future<T> res = promise->getFuture();
+  //InlineTask只需要可以移动，任务直接移进回调
+  scheduler->schedule([task = std::move(task), promise]() mutable {
+    detail::RunTask(std::move(task), promise);
+  });
+  return res;
+}
+
+/**
+ * @brief 切换到指定调度器（线程）上继续执行
+ *
+ * co_await ScheduleOn(Scheduler::GetThis())相当于让出执行权。
+ */
+class ScheduleOn {
+ public:
+  explicit ScheduleOn(Scheduler* scheduler, int thread_id = -1)
+      : m_scheduler(scheduler), m_threadId(thread_id) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> h) const {
+    m_scheduler->schedule([h]() { h.resume(); }, m_threadId);
+  }
+
+  void await_resume() const noexcept {}
+
+ private:
+  Scheduler* m_scheduler;  ///< 目标调度器
+  int m_threadId;          ///< 目标线程，-1表示任意线程
+};
+
+/**
+ * @brief 挂起ms毫秒，通过IOManager的定时器恢复
+ */
+class SleepFor {
+ public:
+  explicit SleepFor(uint64_t ms, IOManager* iom = IOManager::GetThis())
+      : m_ms(ms), m_iom(iom) {}
+
+  bool await_ready() const noexcept { return 0 == m_ms; }
+
+  void await_suspend(std::coroutine_handle<> h) const {
+    //定时器回调本身就作为任务在工作线程上执行，直接恢复
+    m_iom->addTimer(m_ms, [h]() { h.resume(); });
+  }
+
+  void await_resume() const noexcept {}
+
+ private:
+  uint64_t m_ms;     ///< 挂起时长
+  IOManager* m_iom;  ///< 定时器所在的IOManager
+};
+
+/**
+ * @brief 等待fd上的读或写事件
+ *
+ * co_await的结果：事件就绪返回true，超时或者注册事件失败返回false。
+ * fd需要是非阻塞的，事件是边缘触发，就绪后应该一直读写到EAGAIN。
+ */
+class WaitEvent {
+ public:
+  /**
+   * @param fd 文件描述符
+   * @param event IOManager::READ或IOManager::WRITE
+   * @param timeout_ms 超时时间，~0ull表示不超时
+   * @param iom 监听事件的IOManager
+   */
+  WaitEvent(int fd, IOManager::Event event, uint64_t timeout_ms = ~0ull,
+            IOManager* iom = IOManager::GetThis())
+      : m_fd(fd), m_event(event), m_timeoutMs(timeout_ms), m_iom(iom) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  bool await_suspend(std::coroutine_handle<> h) {
+    auto state = std::make_shared<State>();
+    IOManager* iom = m_iom;
+    int fd = m_fd;
+    IOManager::Event event = m_event;
+    m_state = state;
+    if (~0ull != m_timeoutMs) {
+      std::weak_ptr<State> weak_state(state);
+      m_timer = iom->addConditionTimer(
+          m_timeoutMs,
+          [weak_state, iom, fd, event]() {
+            auto s = weak_state.lock();
+            if (nullptr != s) {
+              s->timed_out = true;
+              iom->cancelEvent(fd, event);  //触发事件回调，恢复协程
+            }
+          },
+          weak_state);
+    }
+    if (0 != iom->addEvent(fd, event, [h, state]() { h.resume(); })) {
+      m_failed = true;
+      return false;
+    }
+    //注册成功后协程随时可能在别的线程恢复，之后只能用局部变量
+    if (state->timed_out) {
+      iom->cancelEvent(fd, event);  //定时器在注册之前就已经超时
+    }
+    return true;
+  }
+
+  bool await_resume() {
+    if (nullptr != m_timer) {
+      m_timer->cancel();
+    }
+    return !m_failed && !m_state->timed_out;
+  }
+
+ private:
+  struct State {
+    std::atomic<bool> timed_out{false};  ///< 是否超时
+  };
+
+  int m_fd;                        ///< 文件描述符
+  IOManager::Event m_event;        ///< 等待的事件
+  uint64_t m_timeoutMs;            ///< 超时时间
+  IOManager* m_iom;                ///< 监听事件的IOManager
+  bool m_failed{false};            ///< 注册事件是否失败
+  std::shared_ptr<State> m_state;  ///< 和定时器、事件回调共享的状态
+  Timer::sptr m_timer;             ///< 超时定时器
+};
+
+/**
+ * @brief 在协程里等待Future，完成后在等待时所在的调度器上恢复
+ */
+template <class T>
+auto operator co_await(const Future<T>& future) {
+  struct Awaiter {
+    Future<T> future;
+
+    bool await_ready() const { return future.isReady(); }
+
+    void await_suspend(std::coroutine_handle<> h) const {
+      Scheduler* scheduler = Scheduler::GetThis();
+      future.onReady([scheduler, h]() { detail::ResumeOn(scheduler, h); });
+    }
+
+    T await_resume() const { return future.get(); }  //按值返回，Future可能是临时对象
+  };
+  return Awaiter{future};
+}
+
+}  // namespace East
@@ -6,11 +6,22 @@
  */
 
 #pragma once
-#include <ucontext.h>
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+#include "FiberContext.h"
+#include "InlineTask.h"
 
 namespace East {
+class StackAllocator;
+struct SharedStack;
+struct FiberRegistry;
+class Scheduler;
+class Semaphore;
+
 class Fiber
     : public std::enable_shared_from_this<Fiber> {  //only create on heap
  public:
@@ -18,6 +29,31 @@ class Fiber
 
   enum State { INIT = 0, HOLD = 1, EXEC = 2, TERM = 3, READY = 4, EXCEPT = 5 };
 
+  //协程复用池的统计信息
+  struct PoolStats {
+    uint64_t hits{0};      //从空闲链表中拿到协程的次数
+    uint64_t misses{0};    //需要新建协程的次数
+    uint64_t recycled{0};  //放回空闲链表的次数
+    uint64_t pooled{0};    //当前所有线程空闲链表中的协程数
+  };
+
+  //同步原语等待队列的节点，放在协程对象里而不是栈上：共享栈协程挂起后栈内容会被换出
+  struct WaitNode {
+    std::shared_ptr<Fiber> fiber;   //挂起的协程，唤醒时交给scheduler
+    Scheduler* scheduler{nullptr};  //协程挂起时所在的调度器
+    Semaphore* sem{nullptr};        //不在调度器中运行时用信号量阻塞线程
+    WaitNode* next{nullptr};        //等待队列中的下一个节点
+    uintptr_t data{0};              //同步原语自己使用，比如读写锁记录等待的类型
+  };
+
+  //协程挂起的原因，只在挂起点记录，协程恢复时清掉
+  struct WaitInfo {
+    const char* reason{nullptr};  //挂起原因，比如io/sleep/mutex，nullptr表示没有记录
+    int fd{-1};                   //等待IO时的fd
+    int event{0};                 //等待IO时的事件，IOManager::Event
+    uint64_t since{0};            //开始挂起的时间(ms)
+  };
+
  private:
   Fiber();
 
@@ -26,12 +62,13 @@ class Fiber
   /// @param cb
   /// @param stack_size, if 0, use default stack size
   /// @param run_in_scheduler, please set false if you are not in scheduler
-  Fiber(std::function<void()> cb, size_t stack_size = 0,
-        bool run_in_scheduler = true);
+  /// @param shared_stack, run on the per-thread shared stacks, stack_size is ignored
+  Fiber(InlineTask cb, size_t stack_size = 0,
+        bool run_in_scheduler = true, bool shared_stack = false);
   ~Fiber();
 
   //重置协程函数，并重置状态
-  void reset(std::function<void()> cb);
+  void reset(InlineTask cb);
   //切换到当前协程执行
   void resume();
   //切换到后台执行
@@ -43,6 +80,32 @@ class Fiber
   State getState() const { return m_state; }
   void setState(State state) { m_state = state; }
   uint64_t getId() const { return m_id; }
+  //协程栈大小，共享栈协程返回0
+  uint32_t getStackSize() const { return m_stacksize; }
+  //是否运行在共享栈上
+  bool isSharedStack() const { return m_shared_stack; }
+  //共享栈协程第一次执行后绑定的线程，执行结束前只能在这个线程上恢复，-1表示未绑定
+  int getBoundThread() const { return m_bound_thread; }
+  //是否由调度器恢复执行
+  bool isRunInScheduler() const { return m_run_in_scheduler; }
+  //挂起在同步原语上时使用的等待节点
+  WaitNode* getWaitNode() { return &m_wait_node; }
+  //截止时间(ms，和GetCurrentTimeInMs比较)，0表示没有截止时间
+  uint64_t getDeadline() const { return m_deadline; }
+  void setDeadline(uint64_t deadline) { m_deadline = deadline; }
+  //所属的任务组，0是默认组
+  int getGroup() const { return m_group; }
+  void setGroup(int group) { m_group = group; }
+  //最近一次挂起的原因
+  const WaitInfo& getWaitInfo() const { return m_wait; }
+  //最近一次执行所在的调度器id，没有在调度器中执行过返回0；调度器可能已经析构，按id查找见Scheduler::GetNameById
+  uint64_t getSchedulerId() const {
+    return m_scheduler_id.load(std::memory_order_relaxed);
+  }
+  //协程函数的类型，用来区分协程是从哪里创建的
+  const std::type_info* getSite() const { return m_site; }
+  //从切出时保存的上下文回溯调用栈，返回帧数；正在执行、没有执行过、共享栈的协程返回0
+  size_t backtrace(void** frames, size_t max) const;
 
  public:
   //设置当前协程
@@ -57,17 +120,83 @@ class Fiber
   static uint64_t TotalFibers();
   //获取当前协程id
   static uint64_t GetFiberId();
+  //当前协程的截止时间，没有协程或者没有截止时间返回0
+  static uint64_t CurrentDeadline();
+  //当前协程所属的任务组，没有协程返回0
+  static int CurrentGroup();
+  //当前线程上是否有还没结束的共享栈协程，它们只能在这个线程上恢复，线程不能退出
+  static bool HasBoundFibers();
+  //记录当前协程接下来挂起的原因，reason需要是静态字符串
+  static void SetWaitReason(const char* reason, int fd = -1, int event = 0);
+  //遍历所有存活的协程（不包括主协程），每个线程的协程链表在各自的锁内遍历，回调里不能创建或销毁协程
+  static void ForEach(const std::function<void(const Fiber&)>& cb);
 
   static void MainFunc();
 
+  //从当前线程的空闲链表中取一个参数相同的协程并reset，没有的话新建一个
+  static Fiber::sptr Create(InlineTask cb, size_t stack_size = 0,
+                            bool run_in_scheduler = true,
+                            bool shared_stack = false);
+  //把执行完(TERM)的协程连同栈和上下文放回当前线程的空闲链表，f是唯一引用时才回收
+  static void Recycle(Fiber::sptr& f);
+  //协程复用池的统计信息
+  static PoolStats GetPoolStats();
+  static std::string PoolStatsToString();
+
+  //分配一个协程局部变量的槽位，由FiberLocal在静态初始化时调用
+  static size_t AllocLocalKey();
+  //当前协程key对应槽位的值，没有设置过返回nullptr
+  static void* GetLocal(size_t key);
+  //设置当前协程key对应槽位的值，协程结束、复用或销毁时用destroy释放
+  static void SetLocal(size_t key, void* value, void (*destroy)(void*));
+
+ private:
+  //占用共享栈：换下当前占用者的栈内容，再恢复自己的
+  void claimSharedStack();
+  //把自己在共享栈上已使用的部分拷贝到m_save_buf
+  void saveSharedStack();
+  //执行结束，归还共享栈并解除线程绑定
+  void releaseSharedStack();
+  //释放所有协程局部变量
+  void clearLocals();
+  //加入当前线程的协程链表/从加入时的链表中移出
+  void registerSelf();
+  void unregisterSelf();
+
+  //协程局部变量的槽位
+  struct LocalSlot {
+    void* value{nullptr};
+    void (*destroy)(void*){nullptr};
+  };
+
  private:
-  uint64_t m_id{0};                //协程id
-  uint32_t m_stacksize{0};         //协程栈大小
-  State m_state{INIT};             //协程状态
-  ucontext_t m_ctx;                //协程上下文
-  void* m_stack{nullptr};          // 协程栈指针
-  std::function<void()> m_cb;      //协程函数
-  bool m_run_in_scheduler{false};  //是否在调度器中运行
+  uint64_t m_id{0};                       //协程id
+  uint32_t m_stacksize{0};                //协程栈大小
+  State m_state{INIT};                    //协程状态
+  FiberContext m_ctx;                     //协程上下文
+  void* m_stack{nullptr};                 // 协程栈指针
+  StackAllocator* m_allocator{nullptr};   //协程栈的分配器
+  InlineTask m_cb;                        //协程函数
+  bool m_run_in_scheduler{false};         //是否在调度器中运行
+  bool m_shared_stack{false};             //是否使用共享栈
+  bool m_ctx_pending{false};              //共享栈上的上下文还未创建
+  int m_bound_thread{-1};                 //共享栈协程绑定的线程id
+  SharedStack* m_shared{nullptr};         //当前使用的共享栈
+  char* m_save_buf{nullptr};              //被换下时保存的栈内容
+  size_t m_save_size{0};                  //保存的栈内容大小
+  size_t m_save_cap{0};                   //m_save_buf的容量
+  const std::type_info* m_site{nullptr};  //协程函数的类型，栈使用量按它分组
+  bool m_poisoned{false};                 //栈顶的采样窗口是否填充了毒化字节
+  bool m_sampled{false};                  //这次运行是否采样，TERM时记录栈使用量
+  std::vector<LocalSlot> m_locals;        //协程局部变量，按key下标访问
+  WaitNode m_wait_node;                   //挂起在同步原语上时的等待节点
+  uint64_t m_deadline{0};                 //截止时间，调度器按它排序，子任务继承
+  int m_group{0};                         //所属的任务组，调度器按组公平调度，子任务继承
+  WaitInfo m_wait;                        //最近一次挂起的原因
+  std::atomic<uint64_t> m_scheduler_id{0};  //最近一次执行所在的调度器id
+  FiberRegistry* m_registry{nullptr};     //所在的协程链表，属于创建协程的线程
+  Fiber* m_prev{nullptr};                 //协程链表
+  Fiber* m_next{nullptr};
 };
 
 }  // namespace East
@@ -0,0 +1,91 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 11:02:47
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 11:02:47
+ */
+
+#pragma once
+#include <stddef.h>
+#include <ucontext.h>
+
+//编译期选择协程上下文切换的实现：
+//x86-64/aarch64默认使用手写汇编，只保存callee-saved寄存器，不会有rt_sigprocmask系统调用；
+//定义EAST_FIBER_USE_UCONTEXT（cmake -DEAST_FIBER_CONTEXT=ucontext）或其他架构时退回ucontext
+#if !defined(EAST_FIBER_USE_UCONTEXT) && \
+    (defined(__x86_64__) || defined(__aarch64__))
+#define EAST_FIBER_ASM_CONTEXT 1
+#else
+#define EAST_FIBER_ASM_CONTEXT 0
+#endif
+
+extern "C" {
+//保存当前callee-saved寄存器到栈上，把栈顶写入*from_sp，然后切换到to_sp
+void east_context_swap(void** from_sp, void* to_sp);
+//新协程第一次被切入时的入口，负责调用make时传入的函数
+void east_context_entry();
+}
+
+namespace East {
+
+/**
+ * @brief 基于ucontext的上下文，swapcontext每次都会保存/恢复信号掩码
+ */
+class UContext {
+ public:
+  /**
+   * @brief 用当前执行流初始化上下文（主协程使用）
+   */
+  bool init();
+
+  /**
+   * @brief 在指定的栈上创建一个新的上下文，切入后执行fn
+   * @param stack 栈的低地址
+   * @param size 栈大小
+   * @param fn 入口函数，不允许返回
+   */
+  bool make(void* stack, size_t size, void (*fn)());
+
+  /**
+   * @brief 保存当前上下文到this，并切换到to
+   */
+  bool swap(UContext& to);
+
+  /**
+   * @brief 上下文被切出时的栈顶，不支持的架构返回nullptr
+   */
+  void* stackPointer() const;
+
+ private:
+  ucontext_t m_ctx;
+};
+
+#if EAST_FIBER_ASM_CONTEXT
+/**
+ * @brief 汇编实现的上下文，整个上下文就是切出时的栈顶指针
+ *
+ * 寄存器都保存在协程自己的栈上，切换只需要一次函数调用
+ */
+class AsmContext {
+ public:
+  bool init() { return true; }
+
+  bool make(void* stack, size_t size, void (*fn)());
+
+  bool swap(AsmContext& to) {
+    east_context_swap(&m_sp, to.m_sp);
+    return true;
+  }
+
+  void* stackPointer() const { return m_sp; }
+
+ private:
+  void* m_sp{nullptr};  ///< 切出时的栈顶，寄存器保存在它上方
+};
+
+using FiberContext = AsmContext;
+#else
+using FiberContext = UContext;
+#endif
+
+}  // namespace East
@@ -0,0 +1,73 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 17:35:08
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 17:35:08
+ */
+
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Fiber.h"
+
+namespace East {
+
+/**
+ * @brief 一个协程的快照
+ */
+struct FiberInfo {
+  uint64_t id{0};                       ///< 协程id
+  Fiber::State state{Fiber::INIT};      ///< 协程状态
+  std::string scheduler;                ///< 最近一次执行所在的调度器名称
+  std::string site;                     ///< 协程函数的类型，基本对应创建位置
+  bool shared_stack{false};             ///< 是否使用共享栈
+  uint32_t stack_size{0};               ///< 独立栈大小
+  std::string wait_reason;              ///< 挂起原因，没有记录时为空
+  int fd{-1};                           ///< 等待IO时的fd
+  int event{0};                         ///< 等待IO时的事件，IOManager::Event
+  uint64_t parked_ms{0};                ///< 已经挂起的时长
+  std::vector<std::string> backtrace;   ///< 挂起位置的调用栈
+};
+
+/**
+ * @brief 导出所有存活的协程，用于排查卡住的协程
+ *
+ * 协程只在挂起点（hook的IO、sleep、Fiber同步原语、Channel、Future）记录挂起原因和时间，
+ * 调用栈在导出时才从协程切出时保存的上下文沿帧指针回溯，不导出时没有额外开销。
+ * 共享栈协程和ucontext实现的上下文不回溯调用栈。
+ *
+ * @code
+ * ELOG_INFO(g_logger) << East::FiberInspector::DumpText(true);
+ * @endcode
+ */
+class FiberInspector {
+ public:
+  /**
+   * @brief 收集协程快照
+   * @param parked_only 只收集挂起(HOLD)的协程
+   * @param with_backtrace 是否回溯调用栈
+   * @return 按挂起时长从长到短排序的快照
+   */
+  static std::vector<FiberInfo> Collect(bool parked_only = false,
+                                        bool with_backtrace = true);
+
+  /**
+   * @brief 导出为文本，每个协程一段
+   */
+  static std::string DumpText(bool parked_only = false,
+                              bool with_backtrace = true);
+
+  /**
+   * @brief 导出为JSON数组
+   */
+  static std::string DumpJson(bool parked_only = false,
+                              bool with_backtrace = true);
+
+  /**
+   * @brief 协程状态的名字
+   */
+  static const char* StateToString(Fiber::State state);
+};
+
+}  // namespace East
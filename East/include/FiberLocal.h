@@ -0,0 +1,76 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 13:05:40
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 13:05:40
+ */
+
+#pragma once
+#include <utility>
+#include "Fiber.h"
+#include "Noncopyable.h"
+
+namespace East {
+
+/**
+ * @brief 协程局部变量
+ *
+ * 和thread_local类似，但是每个协程各有一份，协程在hook调用中让出之后，
+ * 同一线程上运行的其他协程看不到它的值。
+ * 一般定义为静态变量，构造时分配一个槽位下标，访问时直接按下标取协程里的槽位。
+ * 值在第一次访问时构造，协程结束(TERM/EXCEPT)、被reset复用或销毁时析构。
+ *
+ * @code
+ * static East::FiberLocal<RequestContext> t_request_ctx;
+ * t_request_ctx->trace_id = ...;
+ * @endcode
+ */
+template <class T>
+class FiberLocal : private noncopymoveable {
+ public:
+  FiberLocal() : m_key(Fiber::AllocLocalKey()) {}
+
+  /**
+   * @brief 获取当前协程的值，没有的话默认构造一个
+   */
+  T* get() {
+    void* p = Fiber::GetLocal(m_key);
+    if (nullptr == p) {
+      T* v = new T();
+      Fiber::SetLocal(m_key, v, &FiberLocal::Destroy);
+      return v;
+    }
+    return static_cast<T*>(p);
+  }
+
+  /**
+   * @brief 当前协程是否已经有值
+   */
+  bool has() const { return nullptr != Fiber::GetLocal(m_key); }
+
+  /**
+   * @brief 设置当前协程的值，旧值会被析构
+   */
+  template <class... Args>
+  T& emplace(Args&&... args) {
+    T* v = new T(std::forward<Args>(args)...);
+    Fiber::SetLocal(m_key, v, &FiberLocal::Destroy);
+    return *v;
+  }
+
+  /**
+   * @brief 提前析构当前协程的值
+   */
+  void reset() { Fiber::SetLocal(m_key, nullptr, nullptr); }
+
+  T& operator*() { return *get(); }
+  T* operator->() { return get(); }
+
+ private:
+  static void Destroy(void* p) { delete static_cast<T*>(p); }
+
+ private:
+  size_t m_key;  ///< 在协程槽位数组中的下标
+};
+
+}  // namespace East
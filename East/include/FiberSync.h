@@ -0,0 +1,359 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 13:40:12
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 13:40:12
+ */
+
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include "Fiber.h"
+#include "Mutex.h"
+#include "Noncopyable.h"
+
+namespace East {
+
+/**
+ * @brief 协程等待队列
+ *
+ * 由Fiber::WaitNode串起来的侵入式FIFO队列，入队出队不分配内存。
+ * 本身不加锁，由使用它的同步原语用自己的自旋锁保护。
+ */
+class FiberWaitQueue {
+ public:
+  bool empty() const { return nullptr == m_head; }
+
+  Fiber::WaitNode* front() const { return m_head; }
+
+  void push(Fiber::WaitNode* node) {
+    node->next = nullptr;
+    if (nullptr != m_tail) {
+      m_tail->next = node;
+    } else {
+      m_head = node;
+    }
+    m_tail = node;
+  }
+
+  Fiber::WaitNode* pop() {
+    Fiber::WaitNode* node = m_head;
+    if (nullptr != node) {
+      m_head = node->next;
+      if (nullptr == m_head) {
+        m_tail = nullptr;
+      }
+      node->next = nullptr;
+    }
+    return node;
+  }
+
+ private:
+  Fiber::WaitNode* m_head{nullptr};  ///< 队头，最早开始等待的节点
+  Fiber::WaitNode* m_tail{nullptr};  ///< 队尾
+};
+
+/**
+ * @brief 挂起和唤醒当前执行流
+ *
+ * 在调度器中运行的协程挂起时让出线程(YieldToHold)，唤醒时重新交给挂起时的调度器；
+ * 其他情况（主协程、调度协程、不在调度器中的线程）退化为用信号量阻塞线程。
+ *
+ * 使用方式：持有同步原语的自旋锁时Prepare并把节点放入等待队列，释放自旋锁后Park。
+ * 唤醒方在自旋锁内把节点出队，释放自旋锁后Wake。
+ * Wake可能发生在协程真正让出之前，调度器会跳过仍处于EXEC状态的协程，等它让出后再执行。
+ */
+class FiberParker {
+ public:
+  /**
+   * @brief 填写当前执行流的等待节点
+   * @param sem 不能挂起协程时阻塞线程用的信号量，由调用者放在线程栈上
+   * @return 当前协程的等待节点
+   */
+  static Fiber::WaitNode* Prepare(Semaphore* sem);
+
+  /**
+   * @brief 挂起当前执行流，直到节点被Wake
+   * @param reason 挂起原因，导出协程时显示，需要是静态字符串
+   */
+  static void Park(Fiber::WaitNode* node, const char* reason = "sync");
+
+  /**
+   * @brief 唤醒等待节点对应的执行流，节点必须已经出队
+   */
+  static void Wake(Fiber::WaitNode* node);
+};
+
+/**
+ * @brief 协程互斥锁
+ *
+ * 竞争时挂起协程而不是阻塞线程，线程可以继续执行其他协程。
+ * 状态：0未加锁，1加锁且没有等待者，2加锁且可能有等待者。
+ * 无竞争时加锁是一次CAS，解锁是一次exchange，只有状态为2时才会去唤醒等待队列。
+ */
+class FiberMutex : private noncopymoveable {
+ public:
+  using LockGuard = ScopedLock<FiberMutex>;  ///< 锁RAII包装器类型
+
+  /**
+   * @brief 加锁，锁被占用时挂起当前协程
+   */
+  void lock() {
+    int expected = 0;
+    if (m_state.compare_exchange_strong(expected, 1, std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+      return;
+    }
+    lockSlow();
+  }
+
+  /**
+   * @brief 尝试加锁，不会挂起
+   * @return 加锁成功返回true
+   */
+  bool tryLock() {
+    int expected = 0;
+    return m_state.compare_exchange_strong(expected, 1,
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 解锁，有等待者时唤醒最早等待的一个
+   */
+  void unlock() {
+    if (2 == m_state.exchange(0, std::memory_order_release)) {
+      wakeOne();
+    }
+  }
+
+ private:
+  void lockSlow();
+  void wakeOne();
+
+ private:
+  std::atomic<int> m_state{0};  ///< 锁状态
+  SpinLock m_waitLock;          ///< 保护等待队列
+  FiberWaitQueue m_waiters;     ///< 等待加锁的协程
+};
+
+/**
+ * @brief 协程读写锁
+ *
+ * 状态字低30位是读者数量，第30位表示写者持有，第31位表示等待队列不为空。
+ * 无竞争时加读锁、加写锁和解锁都是一次原子操作。
+ * 有等待者时新的读者不再进入，避免写者饥饿；唤醒时写者单独唤醒，连续的读者一起唤醒。
+ */
+class FiberRWLock : private noncopymoveable {
+ public:
+  using RLockGuard = ReadScopedLock<FiberRWLock>;   ///< 读锁RAII包装器类型
+  using WLockGuard = WriteScopedLock<FiberRWLock>;  ///< 写锁RAII包装器类型
+
+  /**
+   * @brief 加读锁
+   */
+  void rdlock() {
+    uint32_t s = m_state.load(std::memory_order_relaxed);
+    if (0 == (s & (kWriter | kWaiters)) &&
+        m_state.compare_exchange_weak(s, s + 1, std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+      return;
+    }
+    lockSlow(false);
+  }
+
+  /**
+   * @brief 加写锁
+   */
+  void wrlock() {
+    uint32_t s = 0;
+    if (m_state.compare_exchange_strong(s, kWriter, std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+      return;
+    }
+    lockSlow(true);
+  }
+
+  /**
+   * @brief 释放读锁或写锁
+   */
+  void unlock() {
+    uint32_t prev = 0;
+    if (m_state.load(std::memory_order_relaxed) & kWriter) {
+      prev = m_state.fetch_and(~kWriter, std::memory_order_release);
+    } else {
+      prev = m_state.fetch_sub(1, std::memory_order_release);
+      if (1 != (prev & kReaderMask)) {  //还有其他读者
+        return;
+      }
+    }
+    if (prev & kWaiters) {
+      wakeSlow();
+    }
+  }
+
+ private:
+  static constexpr uint32_t kWriter = 1u << 30;
+  static constexpr uint32_t kWaiters = 1u << 31;
+  static constexpr uint32_t kReaderMask = kWriter - 1;
+
+  void lockSlow(bool writer);
+  void wakeSlow();
+
+ private:
+  std::atomic<uint32_t> m_state{0};  ///< 读者数量和标志位
+  SpinLock m_waitLock;               ///< 保护等待队列
+  FiberWaitQueue m_waiters;  ///< 等待加锁的协程，WaitNode::data为1表示写者
+};
+
+/**
+ * @brief 协程条件变量，配合FiberMutex使用
+ */
+class FiberCondVar : private noncopymoveable {
+ public:
+  /**
+   * @brief 释放mutex并挂起，被唤醒后重新加锁
+   * @param mutex 调用者已经持有的锁
+   */
+  void wait(FiberMutex& mutex);
+
+  /**
+   * @brief 等待直到pred()返回true
+   */
+  template <class Predicate>
+  void wait(FiberMutex& mutex, Predicate pred) {
+    while (!pred()) {
+      wait(mutex);
+    }
+  }
+
+  /**
+   * @brief 唤醒一个等待者
+   */
+  void notifyOne();
+
+  /**
+   * @brief 唤醒所有等待者
+   */
+  void notifyAll();
+
+ private:
+  SpinLock m_waitLock;       ///< 保护等待队列
+  FiberWaitQueue m_waiters;  ///< 等待中的协程
+};
+
+/**
+ * @brief 协程信号量
+ *
+ * 计数为负时表示有等待者。无竞争时wait和notify都是一次原子加减，
+ * 只有计数小于等于0时wait才进入等待队列，只有存在等待者时notify才去唤醒。
+ */
+class FiberSemaphore : private noncopymoveable {
+ public:
+  /**
+   * @brief 构造函数
+   * @param count 初始计数
+   */
+  explicit FiberSemaphore(uint32_t count = 0) : m_count(count) {}
+
+  /**
+   * @brief 计数减一，计数不足时挂起当前协程
+   */
+  void wait() {
+    if (m_count.fetch_sub(1, std::memory_order_acquire) > 0) {
+      return;
+    }
+    waitSlow();
+  }
+
+  /**
+   * @brief 计数大于0时减一，不会挂起
+   * @return 成功减一返回true
+   */
+  bool tryWait() {
+    int64_t c = m_count.load(std::memory_order_relaxed);
+    while (c > 0) {
+      if (m_count.compare_exchange_weak(c, c - 1, std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief 计数加一，有等待者时唤醒一个
+   */
+  void notify() {
+    if (m_count.fetch_add(1, std::memory_order_release) >= 0) {
+      return;
+    }
+    notifySlow();
+  }
+
+ private:
+  void waitSlow();
+  void notifySlow();
+
+ private:
+  std::atomic<int64_t> m_count;  ///< 计数，为负时绝对值是等待者数量
+  SpinLock m_waitLock;           ///< 保护等待队列和m_wakeups
+  FiberWaitQueue m_waiters;      ///< 等待中的协程
+  uint64_t m_wakeups{0};  ///< 等待者已经计入m_count但还没入队时收到的唤醒
+};
+
+/**
+ * @brief 等待一组任务完成
+ *
+ * 派发任务前add，每个任务结束时done，等待方wait直到计数归零。
+ * 无竞争时done是一次原子减，wait在计数已经为0时是一次原子读；
+ * 只有计数归零的那次done会去唤醒等待者，等待方无论等多少个任务都只挂起一次。
+ */
+class WaitGroup : private noncopymoveable {
+ public:
+  /**
+   * @brief 构造函数
+   * @param count 初始计数
+   */
+  explicit WaitGroup(int64_t count = 0) : m_count(count) {}
+
+  /**
+   * @brief 计数加n
+   */
+  void add(int64_t n = 1) { m_count.fetch_add(n, std::memory_order_relaxed); }
+
+  /**
+   * @brief 计数减一，归零时唤醒所有等待者
+   */
+  void done() {
+    if (1 == m_count.fetch_sub(1, std::memory_order_acq_rel)) {
+      wakeAll();
+    }
+  }
+
+  /**
+   * @brief 挂起直到计数归零
+   */
+  void wait() {
+    if (0 == m_count.load(std::memory_order_acquire)) {
+      return;
+    }
+    waitSlow();
+  }
+
+  /**
+   * @brief 当前计数
+   */
+  int64_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+ private:
+  void waitSlow();
+  void wakeAll();
+
+ private:
+  std::atomic<int64_t> m_count;  ///< 还没完成的任务数
+  SpinLock m_waitLock;           ///< 保护等待队列
+  FiberWaitQueue m_waiters;      ///< 等待中的协程
+};
+
+}  // namespace East
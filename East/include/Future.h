@@ -0,0 +1,310 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 15:10:26
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 15:10:26
+ */
+
+#pragma once
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "FiberSync.h"
+#include "Mutex.h"
+#include "Noncopyable.h"
+#include "Scheduler.h"
+
+namespace East {
+
+/**
+ * @brief Future和Promise共享的状态中与值类型无关的部分
+ *
+ * 完成前等待的协程挂在等待队列上，完成时一次性唤醒；then/WhenAll等注册的回调在完成方的执行流中执行。
+ */
+class FutureStateBase : private noncopymoveable {
+ public:
+  //Future<void>的占位值
+  struct Unit {};
+
+  virtual ~FutureStateBase() {}
+
+  bool isReady() const { return m_ready.load(std::memory_order_acquire); }
+
+  /**
+   * @brief 挂起直到完成
+   */
+  void wait();
+
+  /**
+   * @brief 完成后执行cb，已经完成的话直接在当前执行流执行
+   */
+  void onReady(std::function<void()> cb);
+
+  /**
+   * @brief 以异常完成
+   */
+  void setException(std::exception_ptr e);
+
+  /**
+   * @brief 完成时的异常，完成之后才能调用
+   */
+  const std::exception_ptr& getException() const { return m_exception; }
+
+ protected:
+  /**
+   * @brief 已经完成时抛出std::logic_error
+   */
+  void checkUnsetLocked() const;
+
+  /**
+   * @brief 结果写好之后调用：标记完成，释放锁，唤醒等待者并执行回调
+   */
+  void publish(SpinLock::LockGuard& lock);
+
+ protected:
+  SpinLock m_lock;                                ///< 保护以下所有状态
+  std::atomic<bool> m_ready{false};               ///< 是否已经完成
+  std::exception_ptr m_exception;                 ///< 以异常完成时的异常
+  FiberWaitQueue m_waiters;                       ///< 等待完成的协程
+  std::vector<std::function<void()>> m_callbacks;  ///< 完成时执行的回调
+};
+
+template <class T>
+class FutureState : public FutureStateBase {
+ public:
+  using Storage =
+      typename std::conditional<std::is_void<T>::value, Unit, T>::type;
+
+  template <class... Args>
+  void setValue(Args&&... args) {
+    SpinLock::LockGuard lock(m_lock);
+    checkUnsetLocked();
+    m_value.emplace(std::forward<Args>(args)...);
+    publish(lock);
+  }
+
+  /**
+   * @brief 完成时的值，以值完成之后才能调用
+   */
+  const Storage& value() const { return *m_value; }
+
+ private:
+  std::optional<Storage> m_value;  ///< 以值完成时的值
+};
+
+template <class T>
+class Promise;
+
+/**
+ * @brief 异步结果
+ *
+ * 可以复制，所有副本共享同一个结果。get/wait在结果就绪前挂起当前协程，
+ * 由完成方通过Scheduler::schedule恢复；不在调度器中时阻塞线程。
+ *
+ * @code
+ * std::vector<East::Future<int>> futures;
+ * for (int i = 0; i < 100; ++i) {
+ *   futures.push_back(East::Async(iom, [i]() { return call_backend(i); }));
+ * }
+ * East::WhenAll(futures).wait();  //只挂起一次
+ * @endcode
+ */
+template <class T>
+class Future {
+ public:
+  using State = FutureState<T>;
+
+  Future() {}
+  explicit Future(std::shared_ptr<State> state) : m_state(std::move(state)) {}
+
+  /**
+   * @brief 是否关联了Promise
+   */
+  bool valid() const { return nullptr != m_state; }
+
+  bool isReady() const { return m_state->isReady(); }
+
+  /**
+   * @brief 挂起直到完成
+   */
+  void wait() const { m_state->wait(); }
+
+  /**
+   * @brief 等待完成并返回值，以异常完成时重新抛出异常
+   * @return Future<void>返回void，其他返回值的常量引用
+   */
+  decltype(auto) get() const {
+    m_state->wait();
+    if (m_state->getException()) {
+      std::rethrow_exception(m_state->getException());
+    }
+    if constexpr (std::is_void<T>::value) {
+      return;
+    } else {
+      return static_cast<const T&>(m_state->value());
+    }
+  }
+
+  /**
+   * @brief 完成后执行cb，不关心结果；已经完成的话直接执行
+   */
+  void onReady(std::function<void()> cb) const {
+    m_state->onReady(std::move(cb));
+  }
+
+  /**
+   * @brief 以值完成后用值调用f，返回f的结果
+   *
+   * f在完成方的执行流中执行；以异常完成时不调用f，异常传给返回的Future，f抛出的异常也一样。
+   */
+  template <class F>
+  auto then(F&& f) const {
+    using R = typename ResultOf<F>::type;
+    auto promise = std::make_shared<Promise<R>>();
+    Future<R> res = promise->getFuture();
+    std::shared_ptr<State> state = m_state;
+    m_state->onReady([state, promise, f = std::forward<F>(f)]() mutable {
+      if (state->getException()) {
+        promise->setException(state->getException());
+      } else if constexpr (std::is_void<T>::value) {
+        promise->setWith(f);
+      } else {
+        promise->setWith(f, state->value());
+      }
+    });
+    return res;
+  }
+
+ private:
+  template <class F, bool = std::is_void<T>::value>
+  struct ResultOf {
+    using type = typename std::invoke_result<F>::type;
+  };
+  template <class F>
+  struct ResultOf<F, false> {
+    using type = typename std::invoke_result<F, const T&>::type;
+  };
+
+ private:
+  std::shared_ptr<State> m_state;  ///< 与Promise共享的状态
+};
+
+/**
+ * @brief 设置Future的结果，只能设置一次
+ *
+ * 还没设置结果就析构时，Future以std::logic_error("broken promise")完成。
+ */
+template <class T>
+class Promise : private noncopyable {
+ public:
+  Promise() : m_state(std::make_shared<FutureState<T>>()) {}
+
+  Promise(Promise&& other) : m_state(std::move(other.m_state)) {}
+
+  ~Promise() {
+    if (nullptr != m_state && !m_state->isReady()) {
+      try {
+        m_state->setException(
+            std::make_exception_ptr(std::logic_error("broken promise")));
+      } catch (...) {
+      }
+    }
+  }
+
+  Future<T> getFuture() const { return Future<T>(m_state); }
+
+  /**
+   * @brief 以值完成，Promise<void>不带参数
+   */
+  template <class... Args>
+  void setValue(Args&&... args) {
+    m_state->setValue(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief 以异常完成
+   */
+  void setException(std::exception_ptr e) { m_state->setException(e); }
+
+  /**
+   * @brief 调用f(args...)，用它的返回值或者抛出的异常完成
+   */
+  template <class F, class... Args>
+  void setWith(F& f, Args&&... args) {
+    try {
+      if constexpr (std::is_void<T>::value) {
+        f(std::forward<Args>(args)...);
+        setValue();
+      } else {
+        setValue(f(std::forward<Args>(args)...));
+      }
+    } catch (...) {
+      setException(std::current_exception());
+    }
+  }
+
+ private:
+  std::shared_ptr<FutureState<T>> m_state;  ///< 与Future共享的状态
+};
+
+/**
+ * @brief 所有Future都完成（不论成功与否）时完成
+ *
+ * 每个结果再通过各自的get获取。完成时只唤醒一次等待方。
+ */
+template <class T>
+Future<void> WhenAll(const std::vector<Future<T>>& futures) {
+  auto promise = std::make_shared<Promise<void>>();
+  Future<void> res = promise->getFuture();
+  if (futures.empty()) {
+    promise->setValue();
+    return res;
+  }
+  auto left = std::make_shared<std::atomic<size_t>>(futures.size());
+  for (auto& f : futures) {
+    f.onReady([promise, left]() {
+      if (1 == left->fetch_sub(1, std::memory_order_acq_rel)) {
+        promise->setValue();
+      }
+    });
+  }
+  return res;
+}
+
+/**
+ * @brief 任意一个Future完成时完成，值是最先完成的下标
+ */
+template <class T>
+Future<size_t> WhenAny(const std::vector<Future<T>>& futures) {
+  auto promise = std::make_shared<Promise<size_t>>();
+  Future<size_t> res = promise->getFuture();
+  auto fired = std::make_shared<std::atomic<bool>>(false);
+  for (size_t i = 0; i < futures.size(); ++i) {
+    futures[i].onReady([promise, fired, i]() {
+      if (!fired->exchange(true, std::memory_order_acq_rel)) {
+        promise->setValue(i);
+      }
+    });
+  }
+  return res;
+}
+
+/**
+ * @brief 把f调度到scheduler上执行，返回它的结果，f可以只能移动
+ */
+template <class F>
+auto Async(Scheduler* scheduler, F&& f) {
+  using R = typename std::invoke_result<F>::type;
+  auto promise = std::make_shared<Promise<R>>();
+  Future<R> res = promise->getFuture();
+  scheduler->schedule(
+      [promise, f = std::forward<F>(f)]() mutable { promise->setWith(f); });
+  return res;
+}
+
+}  // namespace East
@@ -9,6 +9,8 @@
 #include "Scheduler.h"
 #include "Timer.h"
 
+struct epoll_event;
+
 namespace East {
 
 /**
@@ -98,7 +100,7 @@ class IOManager : public Scheduler, public TimerManager {
   /**
    * @brief 析构函数
    * 
-   * 清理资源，关闭epoll文件描述符和管道
+   * 清理资源，关闭epoll文件描述符和每个线程的唤醒eventfd
    */
   ~IOManager();
 
@@ -164,10 +166,15 @@ class IOManager : public Scheduler, public TimerManager {
   /**
    * @brief 唤醒空闲线程
    * 
-   * 通过管道向epoll写入数据来唤醒等待的线程
+   * 定向唤醒最近阻塞的一个线程，没有阻塞的线程时不需要唤醒
    */
   void tickle() override;
 
+  /**
+   * @brief 写指定线程的eventfd，只唤醒这一个线程
+   */
+  void tickleThread(size_t index) override;
+
   /**
    * @brief 空闲状态处理
    * 
@@ -190,8 +197,27 @@ class IOManager : public Scheduler, public TimerManager {
   void onTimerInsertAtFront() override;
 
  private:
-  int m_epfd{-1};      ///< epoll文件描述符，用于IO多路复用
-  int m_tickleFds[2];  ///< 管道文件描述符，用于线程间通信和唤醒
+  /**
+   * @brief 阻塞之前自旋一段时间，轮询任务队列和epoll（超时为0）
+   * @param events epoll事件数组
+   * @param max_events 数组大小
+   * @param budget_us 本线程的自旋时长，按这次自旋的结果调整
+   * @param res 轮询到的epoll事件数
+   * @return 自旋期间等到了任务或者IO事件返回true，不需要再阻塞
+   */
+  bool spinBeforePark(epoll_event* events, int max_events, uint64_t& budget_us,
+                      int& res);
+
+  /**
+   * @brief 当前线程的唤醒eventfd，第一次调用时创建
+   */
+  int getWakeFd();
+
+ private:
+  int m_epfd{-1};  ///< epoll文件描述符，用于IO多路复用
+  std::vector<int> m_wakeFds;  ///< 每个线程的唤醒eventfd，下标是线程的队列下标
+  std::atomic<bool> m_polling{false};  ///< 是否已经有阻塞的线程在替所有线程等epoll
+  std::atomic<size_t> m_spinningThreads{0};  ///< 阻塞之前正在自旋的线程数
 
   std::atomic<size_t> m_pendingEventCount{0};  ///< 待处理的事件数量
   RWMutexType m_mutex;  ///< 保护fd上下文数组的读写锁
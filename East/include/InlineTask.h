@@ -0,0 +1,202 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 20:42:18
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 20:42:18
+ */
+
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+namespace East {
+
+/**
+ * @brief 只能移动的void()可调用对象，小对象直接放在内部缓冲区
+ *
+ * std::function要求可以拷贝，捕获超过两个指针的lambda就会在堆上分配，每次拷贝再分配一次。
+ * 调度器的函数任务只会被执行一次，从提交到执行只需要移动，
+ * 所以用固定大小的内部缓冲区存放可调用对象，常见的捕获（几个指针、一个shared_ptr、
+ * 一个std::function）都放得下，调度一个回调不需要分配内存；
+ * 放不下或者移动可能抛异常的对象退回到堆上。
+ */
+class InlineTask {
+ public:
+  static constexpr size_t kInlineSize = 48;  ///< 内部缓冲区大小，加上操作表指针整个对象64字节
+
+  InlineTask() noexcept {}
+  InlineTask(std::nullptr_t) noexcept {}
+
+  /**
+   * @brief 从任意void()可调用对象构造，空的std::function和空函数指针构造出空任务
+   */
+  template <class F, class D = typename std::decay<F>::type,
+            class = typename std::enable_if<
+                !std::is_same<D, InlineTask>::value &&
+                std::is_invocable_r<void, D&>::value>::type>
+  InlineTask(F&& f) {
+    if (IsNull(f)) {
+      return;
+    }
+    if constexpr (FitsInline<D>()) {
+      new (m_storage) D(std::forward<F>(f));
+      m_ops = &InlineOps<D>::s_ops;
+    } else {
+      *reinterpret_cast<D**>(m_storage) = new D(std::forward<F>(f));
+      m_ops = &HeapOps<D>::s_ops;
+    }
+  }
+
+  InlineTask(InlineTask&& other) noexcept { moveFrom(other); }
+
+  InlineTask& operator=(InlineTask&& other) noexcept {
+    if (this != &other) {
+      reset();
+      moveFrom(other);
+    }
+    return *this;
+  }
+
+  InlineTask& operator=(std::nullptr_t) noexcept {
+    reset();
+    return *this;
+  }
+
+  InlineTask(const InlineTask&) = delete;
+  InlineTask& operator=(const InlineTask&) = delete;
+
+  ~InlineTask() { reset(); }
+
+  void operator()() { m_ops->invoke(m_storage); }
+
+  explicit operator bool() const noexcept { return nullptr != m_ops; }
+
+  friend bool operator==(const InlineTask& t, std::nullptr_t) noexcept {
+    return !t;
+  }
+  friend bool operator!=(const InlineTask& t, std::nullptr_t) noexcept {
+    return static_cast<bool>(t);
+  }
+  friend bool operator==(std::nullptr_t, const InlineTask& t) noexcept {
+    return !t;
+  }
+  friend bool operator!=(std::nullptr_t, const InlineTask& t) noexcept {
+    return static_cast<bool>(t);
+  }
+
+  void swap(InlineTask& other) noexcept {
+    InlineTask tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  /**
+   * @brief 可调用对象的类型，包装的是std::function时返回它内部的类型，空任务返回typeid(void)
+   */
+  const std::type_info& target_type() const noexcept {
+    return nullptr != m_ops ? m_ops->type(m_storage) : typeid(void);
+  }
+
+  /**
+   * @brief 可调用对象是否放在内部缓冲区，空任务返回true
+   */
+  bool isInline() const noexcept {
+    return nullptr == m_ops || !m_ops->on_heap;
+  }
+
+ private:
+  struct Ops {
+    void (*invoke)(void* storage);
+    void (*move)(void* dst, void* src);  ///< 移动到dst并析构src
+    void (*destroy)(void* storage);
+    const std::type_info& (*type)(const void* storage);
+    bool on_heap;
+  };
+
+  template <class D>
+  static constexpr bool FitsInline() {
+    return sizeof(D) <= kInlineSize &&
+           alignof(D) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible<D>::value;
+  }
+
+  template <class D>
+  static bool IsNull(const D& f) {
+    if constexpr (std::is_pointer<D>::value) {
+      return nullptr == f;
+    } else if constexpr (std::is_same<D, std::function<void()>>::value) {
+      return !f;
+    } else {
+      return false;
+    }
+  }
+
+  template <class D>
+  static const std::type_info& TypeOf(const D& f) {
+    if constexpr (std::is_same<D, std::function<void()>>::value) {
+      return f.target_type();  //调用点统计按真正的回调类型分组
+    } else {
+      (void)f;
+      return typeid(D);
+    }
+  }
+
+  template <class D>
+  struct InlineOps {
+    static D* Get(void* s) { return std::launder(reinterpret_cast<D*>(s)); }
+
+    static void Invoke(void* s) { (*Get(s))(); }
+    static void Move(void* dst, void* src) {
+      new (dst) D(std::move(*Get(src)));
+      Get(src)->~D();
+    }
+    static void Destroy(void* s) { Get(s)->~D(); }
+    static const std::type_info& Type(const void* s) {
+      return TypeOf(*Get(const_cast<void*>(s)));
+    }
+
+    static constexpr Ops s_ops{&Invoke, &Move, &Destroy, &Type, false};
+  };
+
+  template <class D>
+  struct HeapOps {
+    static D*& Get(void* s) { return *reinterpret_cast<D**>(s); }
+
+    static void Invoke(void* s) { (*Get(s))(); }
+    static void Move(void* dst, void* src) {
+      *reinterpret_cast<D**>(dst) = Get(src);
+    }
+    static void Destroy(void* s) { delete Get(s); }
+    static const std::type_info& Type(const void* s) {
+      return TypeOf(*Get(const_cast<void*>(s)));
+    }
+
+    static constexpr Ops s_ops{&Invoke, &Move, &Destroy, &Type, true};
+  };
+
+  void moveFrom(InlineTask& other) noexcept {
+    if (nullptr != other.m_ops) {
+      other.m_ops->move(m_storage, other.m_storage);
+      m_ops = other.m_ops;
+      other.m_ops = nullptr;
+    }
+  }
+
+  void reset() noexcept {
+    if (nullptr != m_ops) {
+      const Ops* ops = m_ops;
+      m_ops = nullptr;
+      ops->destroy(m_storage);
+    }
+  }
+
+ private:
+  const Ops* m_ops{nullptr};                                  ///< 按类型生成的操作表，空任务为nullptr
+  alignas(std::max_align_t) unsigned char m_storage[kInlineSize];  ///< 内部缓冲区或者堆上对象的指针
+};
+
+}  // namespace East
@@ -0,0 +1,135 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 19:05:42
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 19:05:42
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <new>
+#include <utility>
+#include "Noncopyable.h"
+
+namespace East {
+
+/**
+ * @brief 有界无锁多生产者多消费者队列
+ *
+ * 环形数组，每个槽位带一个序号：序号等于入队位置时槽位可写，等于入队位置+1时槽位可读，
+ * 生产者和消费者各自CAS推进自己的位置，抢到位置后只访问这一个槽位。
+ * 槽位和两个位置都按缓存行对齐，不同线程操作相邻槽位时不会互相让缓存行失效。
+ * 队列满时push返回false，由调用者决定放到哪里，不会阻塞也不会分配内存。
+ */
+template <class T>
+class MpmcQueue : private noncopymoveable {
+ public:
+  /**
+   * @param capacity 容量，向上取整到2的幂，至少为2
+   */
+  explicit MpmcQueue(size_t capacity) {
+    size_t n = 2;
+    while (n < capacity) {
+      n <<= 1;
+    }
+    m_mask = n - 1;
+    m_slots = new Slot[n];
+    for (size_t i = 0; i < n; ++i) {
+      m_slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ~MpmcQueue() {
+    T tmp;
+    while (pop(tmp)) {
+    }
+    delete[] m_slots;
+  }
+
+  /**
+   * @brief 入队
+   * @return 队列满返回false，v保持不变
+   */
+  bool push(T&& v) {
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+      slot = &m_slots[pos & m_mask];
+      size_t seq = slot->seq.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (0 == diff) {
+        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  //槽位上一轮的数据还没被取走，队列满
+      } else {
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+    new (slot->storage) T(std::move(v));
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief 出队
+   * @return 队列空返回false
+   */
+  bool pop(T& v) {
+    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+      slot = &m_slots[pos & m_mask];
+      size_t seq = slot->seq.load(std::memory_order_acquire);
+      intptr_t diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (0 == diff) {
+        if (m_dequeuePos.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  //槽位还没写入，队列空
+      } else {
+        pos = m_dequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+    T* p = slot->data();
+    v = std::move(*p);
+    p->~T();
+    slot->seq.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief 近似的元素个数，并发修改时只能作为参考
+   */
+  size_t size() const {
+    size_t enq = m_enqueuePos.load(std::memory_order_relaxed);
+    size_t deq = m_dequeuePos.load(std::memory_order_relaxed);
+    return enq > deq ? enq - deq : 0;
+  }
+
+  bool empty() const { return 0 == size(); }
+
+  size_t capacity() const { return m_mask + 1; }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<size_t> seq{0};
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T* data() { return std::launder(reinterpret_cast<T*>(storage)); }
+  };
+
+  Slot* m_slots{nullptr};                          ///< 槽位数组
+  size_t m_mask{0};                                ///< 容量-1
+  alignas(64) std::atomic<size_t> m_enqueuePos{0};  ///< 下一个入队位置
+  alignas(64) std::atomic<size_t> m_dequeuePos{0};  ///< 下一个出队位置
+};
+
+}  // namespace East
@@ -0,0 +1,177 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 22:15:36
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 22:15:36
+ */
+
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "FiberSync.h"
+#include "Mutex.h"
+#include "Noncopyable.h"
+#include "Thread.h"
+
+namespace East {
+
+/**
+ * @brief 执行阻塞调用的线程池
+ *
+ * hook覆盖不到的阻塞调用（getaddrinfo、普通文件的read/fsync、压缩、加解密、第三方SDK）
+ * 直接在IOManager的线程上执行会卡住这个线程上的所有协程。run把调用交给池里的线程执行，
+ * 调用方协程挂起，执行完后回到挂起时的调度器继续；不在调度器中时阻塞调用线程。
+ *
+ * 池里的线程不开启hook，调用按原样阻塞。排队的调用数有上限，满了之后调用方挂起等待空位，
+ * 阻塞调用变慢时压力留在调用方，不会无限堆积。
+ *
+ * f会被移动或拷贝到堆上再交给池里的线程。共享栈协程挂起后栈会被其他协程覆盖，
+ * 在共享栈协程里调用时f不能按引用捕获栈上的变量，结果通过返回值带回来。
+ *
+ * @code
+ * //在IOManager的协程中
+ * addrinfo* res = nullptr;
+ * int rt = East::offload([&]() { return getaddrinfo(host, "80", &hints, &res); });
+ * @endcode
+ */
+class OffloadPool : private noncopymoveable {
+ public:
+  /**
+   * @brief 运行统计，时间单位为微秒
+   */
+  struct Stats {
+    size_t threads{0};         ///< 线程数
+    size_t max_queue{0};       ///< 排队上限
+    size_t queued{0};          ///< 正在排队的调用数
+    size_t running{0};         ///< 正在执行的调用数
+    uint64_t max_queued{0};    ///< 排队数的最大值
+    uint64_t submitted{0};     ///< 提交的调用数
+    uint64_t completed{0};     ///< 执行完的调用数
+    uint64_t full_waits{0};    ///< 队列满时调用方等待的次数
+    uint64_t wait_us{0};       ///< 累计排队时间
+    uint64_t max_wait_us{0};   ///< 单次最长排队时间
+    uint64_t run_us{0};        ///< 累计执行时间
+  };
+
+  /**
+   * @param threads 线程数，至少为1
+   * @param max_queue 排队上限，至少为1
+   */
+  OffloadPool(const std::string& name, size_t threads, size_t max_queue);
+
+  /**
+   * @brief 执行完已经排队的调用后退出所有线程
+   */
+  ~OffloadPool();
+
+  /**
+   * @brief 在池里的线程执行f，挂起当前执行流直到执行完
+   * @return f的返回值，f抛出的异常在调用方重新抛出
+   */
+  template <class F>
+  auto run(F&& f) {
+    using R = typename std::invoke_result<F>::type;
+    //可调用对象和结果都放在堆上：共享栈协程挂起时栈内容会被换出，
+    //池里的线程不能读写它的栈，包括f本身
+    auto call = std::make_unique<Call<typename std::decay<F>::type, R>>(
+        std::forward<F>(f));
+    submit(call.get());
+    if (call->exception) {
+      std::rethrow_exception(call->exception);
+    }
+    if constexpr (!std::is_void<R>::value) {
+      return R(std::move(*call->value));
+    }
+  }
+
+  Stats getStats() const;
+
+  const std::string& getName() const { return m_name; }
+
+  /**
+   * @brief 默认线程池，第一次使用时按offload.threads和offload.max_queue创建
+   */
+  static OffloadPool* GetDefault();
+
+ private:
+  /**
+   * @brief 一次调用，由调用方持有，池里的线程执行完后不再访问
+   */
+  struct Job {
+    virtual ~Job() {}
+    virtual void invoke() = 0;
+
+    Job* next{nullptr};
+    Fiber::WaitNode* node{nullptr};  ///< 调用方的等待节点
+    uint64_t enqueue_ns{0};          ///< 入队时间
+    std::exception_ptr exception;    ///< f抛出的异常
+  };
+
+  template <class F, class R>
+  struct Call : public Job {
+    template <class G>
+    explicit Call(G&& f) : fn(std::forward<G>(f)) {}
+
+    void invoke() override {
+      try {
+        if constexpr (std::is_void<R>::value) {
+          fn();
+        } else {
+          value.emplace(fn());
+        }
+      } catch (...) {
+        exception = std::current_exception();
+      }
+    }
+
+    F fn;  ///< 移动或拷贝过来的可调用对象
+    std::optional<typename std::conditional<std::is_void<R>::value, int,
+                                            R>::type>
+        value;
+  };
+
+  /**
+   * @brief 排队并挂起直到执行完，队列满时先挂起等待空位
+   */
+  void submit(Job* job);
+
+  void threadMain();
+
+ private:
+  std::string m_name;
+  size_t m_maxQueue;                     ///< 排队上限
+  std::vector<Thread::sptr> m_threads;   ///< 工作线程
+  mutable Mutex m_mutex;                 ///< 保护以下队列和等待者
+  Job* m_head{nullptr};                  ///< 排队的调用，FIFO
+  Job* m_tail{nullptr};
+  size_t m_queued{0};                    ///< 排队的调用数
+  FiberWaitQueue m_spaceWaiters;         ///< 等待空位的调用方
+  bool m_stopping{false};                ///< 析构中，线程执行完排队的调用后退出
+  Semaphore m_sem;                       ///< 每排队一个调用通知一次
+
+  std::atomic<size_t> m_running{0};
+  std::atomic<uint64_t> m_maxQueued{0};
+  std::atomic<uint64_t> m_submitted{0};
+  std::atomic<uint64_t> m_completed{0};
+  std::atomic<uint64_t> m_fullWaits{0};
+  std::atomic<uint64_t> m_waitUs{0};
+  std::atomic<uint64_t> m_maxWaitUs{0};
+  std::atomic<uint64_t> m_runUs{0};
+};
+
+/**
+ * @brief 在默认线程池执行阻塞调用f，挂起当前协程直到执行完，返回f的结果
+ */
+template <class F>
+auto offload(F&& f) {
+  return OffloadPool::GetDefault()->run(std::forward<F>(f));
+}
+
+}  // namespace East
@@ -7,14 +7,18 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <iostream>
 #include <list>
+#include <map>
 #include <memory>
 #include <string>
 #include <typeinfo>
 #include <vector>
 #include "Elog.h"  //debug
 #include "Fiber.h"
+#include "MpmcQueue.h"
 #include "Thread.h"
 
 namespace East {
@@ -27,12 +31,82 @@ namespace East {
  * 支持两种工作模式：
  * 1. 使用调用者线程参与调度（use_caller = true）
  * 2. 创建独立的线程池进行调度（use_caller = false）
+ *
+ * 每个线程有自己的本地队列和收件箱，工作线程提交的任务不经过全局锁，
+ * 空闲的线程从其他线程的本地队列偷任务。
+ * 其他线程提交的任务进全局的无锁有界队列，队列满时溢出到加锁的链表。
+ * 任务可以分到不同的任务组，组之间按权重公平分配工作线程的时间，见addGroup。
  */
 class Scheduler {
  public:
   using sptr = std::shared_ptr<Scheduler>;
   using MutexType = Mutex;
 
+  /**
+   * @brief EDF模式下，截止时间已过、还没开始执行的任务的处理方式
+   */
+  enum ExpiredPolicy {
+    EXPIRED_RUN = 0,       ///< 照常执行，只计数
+    EXPIRED_DROP = 1,      ///< 直接丢弃
+    EXPIRED_CALLBACK = 2,  ///< 不执行，交给回调处理
+  };
+
+  /**
+   * @brief 过期任务回调，参数是任务本身（协程任务或函数任务二选一）和它的截止时间
+   *
+   * 在调度线程的调度协程中执行，不能阻塞。
+   */
+  using ExpiredCallback = std::function<void(
+      Fiber::sptr fiber, InlineTask cb, uint64_t deadline)>;
+
+  /**
+   * @brief 截止时间相关的统计
+   */
+  struct DeadlineStats {
+    uint64_t scheduled = 0;  ///< 带截止时间调度的任务数
+    uint64_t expired = 0;    ///< 开始执行前就已经过期的任务数
+    uint64_t dropped = 0;    ///< 过期后被丢弃或交给回调、没有执行的任务数
+  };
+
+  /**
+   * @brief 唤醒相关的统计
+   */
+  struct WakeupStats {
+    uint64_t issued = 0;  ///< 定向唤醒阻塞线程的次数
+    uint64_t merged = 0;  ///< 已经有唤醒在路上、被合并掉的次数
+    uint64_t useful = 0;  ///< 被唤醒的线程取到了任务
+    uint64_t wasted = 0;  ///< 被唤醒的线程没有取到任务
+  };
+
+  static constexpr int kDefaultGroup = 0;  ///< 默认任务组
+  static constexpr int kMaxGroups = 16;    ///< 最多的任务组数，包括默认组
+  static constexpr size_t kMaxThreads = 256;  ///< 最多的线程数，包括调用者线程
+
+  /**
+   * @brief 任务组相关的统计，只有添加过任务组之后才统计
+   */
+  struct GroupStats {
+    std::string name;          ///< 任务组名称
+    uint32_t weight = 0;       ///< 权重
+    bool priority = false;     ///< 是否是优先通道
+    size_t depth = 0;          ///< 排队中的任务数
+    uint64_t scheduled = 0;    ///< 调度的次数，协程每次重新调度都算一次
+    uint64_t executed = 0;     ///< 取出执行的次数
+    uint64_t wait_us = 0;      ///< 从调度到取出的总等待时间(us)
+    uint64_t max_wait_us = 0;  ///< 最长的等待时间(us)
+    uint64_t run_us = 0;       ///< 占用工作线程的总时间(us)
+  };
+
+  /**
+   * @brief 线程当前所在的位置
+   */
+  struct ThreadPlacement {
+    int thread_id = -1;     ///< 线程id
+    std::vector<int> cpus;  ///< 允许运行的CPU
+    int cpu = -1;           ///< 最近一次运行的CPU
+    int node = -1;          ///< cpu所在的NUMA节点，不知道时为-1
+  };
+
   /**
    * @brief 构造函数
    * @param threads 工作线程数量（不包括调用者线程）
@@ -53,6 +127,19 @@ class Scheduler {
    */
   const std::string& getName() const { return m_name; }
 
+  /**
+   * @brief 获取调度器id，进程内唯一，析构后也不会分配给别的调度器
+   */
+  uint64_t getId() const { return m_id; }
+
+  /**
+   * @brief 按id查找还没有析构的调度器的名称
+   * @param id 调度器id
+   * @param name 找到时写入名称
+   * @return 调度器已经析构或者id无效时返回false
+   */
+  static bool GetNameById(uint64_t id, std::string& name);
+
  public:
   /**
    * @brief 获取当前线程的协程调度器
@@ -92,19 +179,59 @@ class Scheduler {
    * @brief 调度协程任务（模板方法）
    * @param task 要调度的协程任务，支持右值引用
    * @param thread_id 指定执行线程ID，-1表示任意线程
+   * @param shared_stack 函数任务是否在共享栈上执行，协程任务以协程自身的设置为准
    * 
    * 将协程任务添加到调度队列中，调度器会自动选择合适的线程执行。
    * 支持协程对象和函数对象的调度。
+   * 大量长时间挂起的连接可以使用共享栈，挂起时只保留实际用到的栈内容。
    */
   template <class Task>
-  void schedule(Task&& task, int thread_id = -1) {
-    bool need_tickle = false;
-    {
-      MutexType::LockGuard lock(m_mutex);
-      need_tickle = scheduleNoLock(std::forward<Task>(task), thread_id);
+  void schedule(Task&& task, int thread_id = -1, bool shared_stack = false) {
+    ExecuteTask et(std::forward<Task>(task), thread_id);
+    et.shared_stack = shared_stack;
+    if (et.isValidTask() && submit(std::move(et), 0)) {
+      tickle();
     }
+  }
 
-    if (need_tickle) {
+  /**
+   * @brief 带截止时间调度任务（模板方法）
+   * @param task 要调度的协程任务
+   * @param deadline 绝对截止时间，单位ms，和GetCurrentTimeInMs比较，0表示沿用默认规则
+   * @param thread_id 指定执行线程ID，-1表示任意线程
+   * @param shared_stack 函数任务是否在共享栈上执行
+   *
+   * 不带截止时间的schedule：协程任务沿用协程自己的截止时间，
+   * 函数任务继承调用者所在协程的截止时间，所以一个请求派生出来的子任务都跟着请求的截止时间走。
+   * 只有开启EDF模式后截止时间才影响调度顺序。
+   */
+  template <class Task>
+  void scheduleWithDeadline(Task&& task, uint64_t deadline, int thread_id = -1,
+                            bool shared_stack = false) {
+    ExecuteTask et(std::forward<Task>(task), thread_id);
+    et.shared_stack = shared_stack;
+    if (et.isValidTask() && submit(std::move(et), deadline)) {
+      tickle();
+    }
+  }
+
+  /**
+   * @brief 在指定的任务组中调度任务（模板方法）
+   * @param task 要调度的协程任务
+   * @param group addGroup返回的任务组id
+   * @param thread_id 指定执行线程ID，-1表示任意线程
+   * @param shared_stack 函数任务是否在共享栈上执行
+   *
+   * 不指定任务组的schedule和deadline一样沿用规则：协程任务沿用协程自己的任务组，
+   * 函数任务继承调用者所在协程的任务组，一个请求派生出的子任务、挂起后恢复的协程都留在原来的组里。
+   */
+  template <class Task>
+  void scheduleInGroup(Task&& task, int group, int thread_id = -1,
+                       bool shared_stack = false) {
+    ExecuteTask et(std::forward<Task>(task), thread_id);
+    et.shared_stack = shared_stack;
+    et.group = group;
+    if (et.isValidTask() && submit(std::move(et), 0)) {
       tickle();
     }
   }
@@ -119,18 +246,111 @@ class Scheduler {
   template <class Iterator>
   void schedule(Iterator begin, Iterator end) {
     bool need_tickle = false;
-    {
-      MutexType::LockGuard lock(m_mutex);
-      while (begin != end) {
-        need_tickle = scheduleNoLock(&*begin, -1) || need_tickle;
-        ++begin;
+    while (begin != end) {
+      ExecuteTask et(&*begin, -1);
+      if (et.isValidTask()) {
+        need_tickle = submit(std::move(et), 0) || need_tickle;
       }
+      ++begin;
     }
     if (need_tickle) {
       tickle();
     }
   }
 
+  /**
+   * @brief 开启或关闭最早截止时间优先(EDF)模式，默认取配置scheduler.edf
+   *
+   * 开启后带截止时间的任务放在单独的队列里按截止时间排序，优先于普通任务执行；
+   * 关闭时已经在排队的带截止时间任务按截止时间顺序挪到普通队列前面。
+   */
+  void setEdf(bool v);
+
+  bool isEdf() const { return m_edf; }
+
+  /**
+   * @brief 设置过期任务的处理方式，需要在start之前设置
+   * @param policy 处理方式
+   * @param cb policy为EXPIRED_CALLBACK时的回调
+   */
+  void setExpiredPolicy(ExpiredPolicy policy, ExpiredCallback cb = nullptr);
+
+  /**
+   * @brief 获取截止时间相关的统计
+   */
+  DeadlineStats getDeadlineStats() const;
+
+  /**
+   * @brief 获取唤醒相关的统计
+   */
+  WakeupStats getWakeupStats() const;
+
+  /**
+   * @brief 添加任务组，运行中也可以添加
+   * @param name 名称，用于统计
+   * @param weight 权重，必须大于0，默认组的权重是100
+   * @param priority 是否是优先通道
+   * @return 任务组id
+   *
+   * 默认组和其他组按加权公平队列分配工作线程的时间：每个组执行任务时按 执行时间/权重 累计虚拟时间，
+   * 取任务时选虚拟时间最小的有任务的组，各组都忙时占用的时间和权重成正比，批量任务不会挤占其他请求。
+   * 优先通道有任务时先于所有非优先组执行，用于健康检查、管理接口这类量小但不能排队的请求。
+   * 指定了线程的任务和EDF模式下带截止时间的任务仍然走原来的队列，只记入组的统计。
+   */
+  int addGroup(const std::string& name, uint32_t weight, bool priority = false);
+
+  /**
+   * @brief 修改任务组的权重，运行中可以调用
+   */
+  void setGroupWeight(int group, uint32_t weight);
+
+  /**
+   * @brief 获取各个任务组的统计，下标是任务组id
+   */
+  std::vector<GroupStats> getGroupStats() const;
+
+  /**
+   * @brief 设置工作线程数的范围（不包括调用者线程），运行中可以调用
+   * @param min 最少的工作线程数
+   * @param max 最多的工作线程数
+   *
+   * min和max相等时线程数固定。否则调度线程每隔scheduler.elastic_interval_ms检查一次，每次增减一个线程：
+   * 没有空闲线程、排队的任务比线程多时增加；空闲线程的比例持续超过一半、没有排队的任务时，
+   * 做检查的线程自己退出，退出前把本地队列和指定给它的任务交给全局队列，指定线程的任务改为任意线程执行。
+   * 调用者线程和还有挂起的共享栈协程的线程不会退出。
+   * 构造时按配置scheduler.elastic_threads中调度器名称对应的[min, max]设置，配置修改后立即生效，
+   * 没有配置时固定为构造时的线程数。
+   */
+  void setThreadRange(size_t min, size_t max);
+
+  /**
+   * @brief 当前的工作线程数，不包括调用者线程
+   */
+  size_t getThreadCount() const { return m_threadCount; }
+
+  /**
+   * @brief 设置工作线程（不包括调用者线程）绑定的CPU，运行中可以调用
+   * @param spec 为空时不绑定；CPU列表如"0-3,8"时第i个工作线程绑定到列表中的第i % n个CPU上；
+   *             "node:0,1"时第i个工作线程绑定到第i % n个NUMA节点的所有CPU上
+   * @return spec格式错误或者其中没有进程可用的CPU时返回false，原来的设置不变
+   *
+   * 新启动的线程在创建时就绑定，本地队列在线程里重新分配，协程栈、ByteArray的节点等在线程里
+   * 分配的内存按首次访问落在线程所在的节点上；已经在运行的线程立即迁移。
+   * 构造时按配置scheduler.affinity中调度器名称对应的spec设置，配置修改后立即生效，
+   * accept和worker使用不同名称的IOManager就可以分开放置。
+   */
+  bool setAffinity(const std::string& spec);
+
+  /**
+   * @brief 当前的CPU绑定设置
+   */
+  std::string getAffinity() const;
+
+  /**
+   * @brief 所有线程（包括调用者线程）当前所在的位置
+   */
+  std::vector<ThreadPlacement> getPlacement() const;
+
  protected:
   /**
    * @brief 调度器主运行循环
@@ -154,6 +374,60 @@ class Scheduler {
    */
   virtual void tickle();
 
+  /**
+   * @brief 唤醒阻塞在idle中的指定线程
+   * @param index 目标线程的队列下标，见getWorkerIndex
+   *
+   * 指定了线程的任务只唤醒目标线程，目标线程没有阻塞时不会调用。
+   * 默认实现调用tickle()。
+   */
+  virtual void tickleThread(size_t index);
+
+  /**
+   * @brief 当前线程的队列下标，范围是[0, kMaxThreads)，不是本调度器的线程返回-1
+   *
+   * 线程退出后下标会给新线程复用，派生类可以按下标保存每个线程的唤醒资源。
+   */
+  int getWorkerIndex() const;
+
+  /**
+   * @brief 标记当前线程是否阻塞在idle中，派生类在idle阻塞前后调用
+   * @param parked 是否阻塞
+   * @return 可以阻塞返回true；已经有可以取的任务时返回false，调用者不应该阻塞
+   *
+   * 标记了阻塞的线程放进阻塞列表，由tickleThread定向唤醒。
+   */
+  bool setParked(bool parked);
+
+  /**
+   * @brief 唤醒最近阻塞的一个线程，用于派生类的tickle
+   * @return 唤醒了一个线程或者已经有唤醒在路上返回true，没有阻塞中的线程返回false
+   *
+   * 阻塞的线程按后进先出排列，最近阻塞的线程缓存最热。
+   * 被唤醒的线程开始取任务之前，后续的唤醒都合并掉：它取到任务后如果还有剩余会继续唤醒下一个。
+   * 停止时不合并，每次调用唤醒一个线程。
+   */
+  bool wakeParkedWorker();
+
+  /**
+   * @brief 当前线程是否有可以取的任务：指定给自己的、全局队列里的或者可以偷的
+   *
+   * 不加锁，只看各个队列的计数，用于idle阻塞之前的自旋。
+   */
+  bool hasReadyTask() const;
+
+  /**
+   * @brief 当前线程是否被选中退出，派生类的idle看到后应该返回
+   */
+  bool retiring() const;
+
+  /**
+   * @brief 线程数可以伸缩时返回检查的间隔(ms)，否则返回0
+   *
+   * 线程数的检查在调度循环中进行，派生类的idle阻塞等待时不应该超过这个时间，否则全部空闲时不会减少线程。
+   */
+  uint64_t adjustInterval() const;
+
   /**
    * @brief 空闲处理协程的虚函数
    * 
@@ -169,27 +443,6 @@ class Scheduler {
   virtual bool stopping();
 
  private:
-  /**
-   * @brief 无锁的任务调度（模板方法）
-   * @param task 要调度的任务
-   * @param thread_id 指定执行线程ID
-   * @return 是否需要唤醒其他线程
-   * 
-   * 内部使用的无锁任务添加方法，调用者需要确保线程安全。
-   */
-  template <class Task>
-  bool scheduleNoLock(Task&& task, int thread_id = -1) {
-    bool need_tickle = m_tasks.empty();
-    ExecuteTask et(std::forward<Task>(task), thread_id);
-    if (et.fiber || et.cb) {
-      m_tasks.emplace_back(std::move(et));
-      ELOG_DEBUG(ELOG_NAME("system"))
-          << "Add new task, type: " << typeid(decltype(task)).name()
-          << ", task id: " << et.getTaskId() << ", thread id: " << thread_id;
-    }
-    return need_tickle;
-  }
-
   /**
    * @brief 全局任务ID计数器
    * 
@@ -205,26 +458,32 @@ class Scheduler {
    */
   struct ExecuteTask {
     Fiber::sptr fiber;         ///< 协程任务指针
-    std::function<void()> cb;  ///< 函数任务回调
+    InlineTask cb;             ///< 函数任务回调，小对象不在堆上分配
 
-    int thread_id;  ///< 指定执行线程ID，-1表示任意线程
-    int task_id;    ///< 任务唯一标识符，用于调试
+    int thread_id;             ///< 指定执行线程ID，-1表示任意线程
+    int task_id;               ///< 任务唯一标识符，用于调试
+    bool shared_stack{false};  ///< 函数任务是否在共享栈上执行
+    int group{-1};             ///< 任务组，-1表示沿用协程或者调用者所在协程的任务组
+    uint64_t deadline{0};      ///< 截止时间(ms)，0表示没有
+    uint64_t enqueue_ns{0};    ///< 调度的时间，只有添加过任务组之后才记录
 
     /**
      * @brief 协程任务构造函数
      * @param f 协程智能指针
-     * @param id 指定线程ID
+     * @param id 指定线程ID，已绑定线程的共享栈协程只能回到绑定的线程
      */
     ExecuteTask(Fiber::sptr f, int id)
-        : fiber(f), thread_id(id), task_id(++s_task_id) {}
+        : fiber(f),
+          thread_id(BoundThread(f.get(), id)),
+          task_id(++s_task_id) {}
 
     /**
      * @brief 函数任务构造函数
-     * @param f 函数回调
+     * @param f 函数回调，lambda等可调用对象直接移动进来，不经过std::function
      * @param id 指定线程ID
      */
-    ExecuteTask(std::function<void()> f, int id)
-        : cb(f), thread_id(id), task_id(++s_task_id) {}
+    ExecuteTask(InlineTask f, int id)
+        : cb(std::move(f)), thread_id(id), task_id(++s_task_id) {}
 
     /**
      * @brief 协程任务移动构造函数
@@ -232,7 +491,7 @@ class Scheduler {
      * @param id 指定线程ID
      */
     ExecuteTask(Fiber::sptr* f, int id)
-        : thread_id(id),
+        : thread_id(BoundThread(f->get(), id)),
           task_id(++s_task_id) {  //外部直接交出所有权，转移到ExecuteTask中
       fiber.swap(*f);
     }
@@ -243,10 +502,18 @@ class Scheduler {
      * @param id 指定线程ID
      */
     ExecuteTask(std::function<void()>* f, int id)
-        : thread_id(id), task_id(++s_task_id) {
-      cb.swap(*f);
+        : cb(std::move(*f)), thread_id(id), task_id(++s_task_id) {
+      *f = nullptr;
     }
 
+    /**
+     * @brief 函数任务移动构造函数
+     * @param f 函数回调的指针，构造后原任务为空
+     * @param id 指定线程ID
+     */
+    ExecuteTask(InlineTask* f, int id)
+        : cb(std::move(*f)), thread_id(id), task_id(++s_task_id) {}
+
     /**
      * @brief 默认构造函数
      */
@@ -258,6 +525,17 @@ class Scheduler {
      */
     int getTaskId() const { return task_id; }
 
+    /**
+     * @brief 协程任务实际要执行的线程
+     * @param f 协程指针
+     * @param id 调用者指定的线程ID
+     * @return 共享栈协程执行过程中返回绑定的线程，否则返回id
+     */
+    static int BoundThread(Fiber* f, int id) {
+      return (nullptr != f && f->getBoundThread() != -1) ? f->getBoundThread()
+                                                         : id;
+    }
+
     /**
      * @brief 重置任务状态
      * 
@@ -267,6 +545,10 @@ class Scheduler {
       fiber = nullptr;
       cb = nullptr;
       thread_id = -1;
+      shared_stack = false;
+      group = -1;
+      deadline = 0;
+      enqueue_ns = 0;
     }
 
     /**
@@ -300,18 +582,210 @@ class Scheduler {
         return false;
       return true;
     }
+
+    /**
+     * @brief 任务是否还没开始执行过，只有没开始的任务过期后可以丢弃
+     */
+    bool notStarted() const {
+      return getTaskType() == FUNCTION ||
+             (getTaskType() == FIBER && fiber->getState() == Fiber::INIT);
+    }
   };
 
+  struct Worker;
+  struct Group;
+
+  static thread_local Worker* t_worker;  ///< 当前线程的任务队列
+
+  /**
+   * @brief 把任务放进合适的队列
+   * @param task 要调度的任务
+   * @param deadline 截止时间，0表示协程任务沿用协程的截止时间，函数任务继承当前协程的截止时间
+   * @return 是否需要唤醒其他线程
+   *
+   * - 指定了线程的任务放进目标线程的收件箱（多生产者单消费者），其他线程不会看到它，
+   *   EDF模式下带截止时间的由目标线程按截止时间排序
+   * - 本调度器工作线程提交的任务放进自己的本地队列，自己后进先出地取，空闲线程从另一端偷
+   * - 其他线程提交的任务和EDF模式下没有指定线程、带截止时间的任务放进全局队列
+   */
+  bool submit(ExecuteTask&& task, uint64_t deadline);
+
+  /**
+   * @brief 执行完仍是READY的协程放回本地队列被偷的一端，让队列里其他任务先执行
+   */
+  void requeue(Fiber::sptr fiber);
+
+  /**
+   * @brief 按顺序从EDF队列、收件箱、本地队列、全局队列取任务，都没有的话去其他线程偷
+   * @param worker 当前线程的队列
+   * @param task 取出的任务
+   * @return 是否取到了任务
+   */
+  bool takeTask(Worker* worker, ExecuteTask& task);
+
+  /**
+   * @brief 从全局队列中批量取任务，第一个通过task返回，其余放进本地队列
+   * @param worker 当前线程的队列
+   * @param task 取出的任务
+   * @return 是否取到了任务
+   */
+  bool takeGlobal(Worker* worker, ExecuteTask& task);
+
+  /**
+   * @brief 放进全局队列，没有指定线程的任务优先放进无锁队列
+   * @return 全局队列之前是否为空
+   */
+  bool pushGlobal(ExecuteTask&& task);
+
+  /**
+   * @brief 目标线程阻塞在idle中时唤醒它
+   */
+  void wakeWorker(Worker* worker);
+
+  /**
+   * @brief 当前线程对应的队列，不是本调度器的线程返回nullptr
+   */
+  Worker* currentWorker() const;
+
+  /**
+   * @brief 线程id对应的队列，没有返回nullptr
+   */
+  Worker* findWorker(int thread_id) const;
+
+  /**
+   * @brief 按截止时间插入EDF队列，截止时间相同的按调度顺序
+   */
+  void insertByDeadlineNoLock(ExecuteTask&& task);
+
+  /**
+   * @brief 从全局队列或EDF队列中取出当前线程可以执行的第一个任务
+   * @param tasks 任务队列
+   * @param task 取出的任务
+   * @return 是否取到了任务
+   */
+  bool takeTaskNoLock(std::list<ExecuteTask>& tasks, ExecuteTask& task);
+
+  /**
+   * @brief 处理已经过期、还没开始执行的任务
+   * @return 任务已经被丢弃或交给回调，不需要再执行返回true
+   */
+  bool handleExpired(ExecuteTask& task);
+
+  /**
+   * @brief 选出这次应该取任务的组：有任务的优先通道，否则是虚拟时间最小的组
+   * @param include_default 是否参与比较默认组，默认组不看是否有任务
+   * @return 没有可选的组返回nullptr
+   */
+  Group* pickGroup(bool include_default) const;
+
+  /**
+   * @brief 从非默认组的队列中取一个任务
+   */
+  bool takeGroup(Group* group, ExecuteTask& task);
+
+  /**
+   * @brief 默认组没有任务时从其他组中取
+   */
+  bool takeAnyGroup(ExecuteTask& task);
+
+  /**
+   * @brief 任务取出准备执行，记录等待时间
+   * @return 任务所属的组
+   */
+  Group* beginGroupTask(const ExecuteTask& task);
+
+  /**
+   * @brief 任务执行完一段，按执行时间累计组的虚拟时间
+   */
+  void chargeGroup(Group* group, uint64_t run_ns);
+
+  /**
+   * @brief 按配置设置线程数的范围
+   */
+  void applyThreadRange(
+      const std::map<std::string, std::vector<uint32_t>>& ranges);
+
+  /**
+   * @brief 按配置设置绑定的CPU
+   */
+  void applyAffinity(const std::map<std::string, std::string>& specs);
+
+  /**
+   * @brief 第index个工作线程绑定的CPU，不绑定时为空，需要持有m_mutex
+   */
+  std::vector<int> workerCpus(size_t index) const;
+
+  /**
+   * @brief 定期按负载增减线程
+   * @param worker 当前线程的队列
+   * @return 当前线程被选中退出返回true
+   */
+  bool adjustThreads(Worker* worker);
+
+  /**
+   * @brief 为worker启动线程，需要持有m_mutex
+   */
+  void startThread(Worker* worker);
+
+  /**
+   * @brief 增加一个工作线程，优先复用已经退出的线程的队列，需要持有m_mutex
+   */
+  void addThread();
+
+  /**
+   * @brief 退出前把当前线程队列中的任务交给全局队列
+   */
+  void retire(Worker* worker);
+
+  /**
+   * @brief 把已经退出的线程收件箱里的任务交给全局队列，改为任意线程执行
+   */
+  void handOffInbox(Worker* worker);
+
  private:
-  MutexType m_mutex;                    ///< 保护共享数据的互斥锁
+  mutable MutexType m_mutex;            ///< 保护全局队列和线程池
   std::vector<Thread::sptr> m_threads;  ///< 工作线程池
-  std::list<ExecuteTask> m_tasks;       ///< 待执行任务队列
+  MpmcQueue<ExecuteTask> m_injectQueue;  ///< 全局无锁队列，其他线程提交的任务
+  std::list<ExecuteTask> m_tasks;  ///< 全局队列满时溢出的任务，以及指定的线程还没启动的任务
+  std::vector<Worker*> m_workers;       ///< 每个线程的任务队列，大小固定为kMaxThreads
+  std::atomic<size_t> m_workerSlots{0};  ///< m_workers中已经分配的队列数，只增不减
+  size_t m_defaultThreads = 0;           ///< 构造时的工作线程数，没有配置范围时使用
+  std::atomic<size_t> m_minThreads{0};   ///< 最少的工作线程数
+  std::atomic<size_t> m_maxThreads{0};   ///< 最多的工作线程数
+  std::atomic<uint64_t> m_lastAdjust{0};  ///< 上一次检查线程数的时间(ms)
+  std::atomic<uint32_t> m_idleRatio{0};   ///< 平滑后的空闲线程比例，千分比
+  uint64_t m_rangeListener = 0;           ///< 线程数范围配置的监听器
+  std::string m_affinity;                 ///< 工作线程绑定CPU的设置
+  std::vector<std::vector<int>> m_affinityCpus;  ///< 按设置展开的CPU集合，第i个工作线程用第i % n个
+  uint64_t m_affinityListener = 0;        ///< CPU绑定配置的监听器
+  std::atomic<size_t> m_pendingTasks{0};  ///< 所有队列中还没开始执行的任务数
+  std::atomic<size_t> m_globalTasks{0};   ///< 溢出链表和EDF队列中的任务数
+  size_t m_batchSize = 16;                ///< 从加锁的共享队列一次最多取的任务数
+  std::atomic<size_t> m_overflowTasks{0};  ///< 溢出链表中没有指定线程的任务数，不为0时新任务也进链表
+  std::list<ExecuteTask> m_deadlineTasks;  ///< EDF模式下按截止时间排序的任务队列
+  std::atomic<bool> m_edf{false};          ///< 是否开启EDF模式
+  std::atomic<int> m_expiredPolicy{EXPIRED_RUN};  ///< 过期任务的处理方式
+  ExpiredCallback m_expiredCallback;              ///< 过期任务回调
+  std::atomic<uint64_t> m_deadlineScheduled{0};   ///< 带截止时间调度的任务数
+  std::atomic<uint64_t> m_deadlineExpired{0};     ///< 开始执行前过期的任务数
+  std::atomic<uint64_t> m_deadlineDropped{0};     ///< 过期后没有执行的任务数
+  SpinLock m_parkedLock;                   ///< 保护m_parkedWorkers
+  std::vector<Worker*> m_parkedWorkers;    ///< 阻塞在idle中的线程，后进先出
+  std::atomic<bool> m_wakePending{false};  ///< 有唤醒在路上，被唤醒的线程还没开始取任务
+  std::atomic<uint64_t> m_wakeIssued{0};   ///< 定向唤醒的次数
+  std::atomic<uint64_t> m_wakeMerged{0};   ///< 合并掉的唤醒次数
+  std::atomic<uint64_t> m_wakeUseful{0};   ///< 唤醒后取到任务的次数
+  std::atomic<uint64_t> m_wakeWasted{0};   ///< 唤醒后没有取到任务的次数
+  std::vector<Group*> m_groups;            ///< 任务组，下标是组id，大小固定为kMaxGroups
+  std::atomic<int> m_groupCount{1};        ///< 已添加的任务组数，包括默认组
+  std::atomic<size_t> m_groupTasks{0};     ///< 非默认组队列中排队的任务数
   Fiber::sptr m_rootFiber;              ///< 主协程，用于调度管理
   std::string m_name;                   ///< 调度器名称
+  uint64_t m_id{0};                     ///< 调度器id，见getId
 
  protected:
   std::vector<int> m_threadIds;                 ///< 所有线程ID列表
-  size_t m_threadCount = 0;                     ///< 工作线程数量
+  std::atomic<size_t> m_threadCount{0};         ///< 工作线程数量
   std::atomic<size_t> m_activeThreadCount = 0;  ///< 当前活跃线程数量
   std::atomic<size_t> m_idleThreadCount = 0;    ///< 当前空闲线程数量
   bool m_stopping = true;                       ///< 调度器停止标志
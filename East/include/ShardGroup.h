@@ -0,0 +1,126 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 23:05:12
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 23:05:12
+ */
+
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Address.h"
+#include "Future.h"
+#include "IOManager.h"
+#include "Noncopyable.h"
+#include "TcpServer.h"
+
+namespace East {
+
+/**
+ * @brief 每个核一个线程、互不共享的IOManager组
+ *
+ * 一个IOManager的所有线程共用一个epoll、一组任务队列和一张fd上下文表，
+ * 短请求为主时线程之间的同步开销占了大头。ShardGroup创建N个单线程的IOManager(分片)，
+ * 每个分片的线程绑定到一个核上，有自己的epoll、定时器、任务队列和fd上下文表。
+ * serve在每个分片上各启动一个服务器，监听socket都设置SO_REUSEPORT绑定同一个地址，
+ * 由内核把新连接分给各个分片，连接从accept到关闭都在同一个线程上处理。
+ *
+ * 分片之间偶尔需要交互时用post/call/broadcast把任务投递到目标分片执行，
+ * 不要直接访问其他分片的数据。
+ *
+ * @code
+ * East::ShardGroup group(4, "http");
+ * group.serve(addrs, [](East::IOManager* shard) {
+ *   return std::make_shared<East::Http::HttpServer>(true, shard, shard);
+ * });
+ * //在某个分片的协程中，到分片0上读它的数据
+ * size_t n = group.call(0, []() { return local_cache.size(); }).get();
+ * @endcode
+ */
+class ShardGroup : private noncopymoveable {
+ public:
+  using ServerFactory = std::function<TcpServer::sptr(IOManager* shard)>;
+
+  /**
+   * @param count 分片数，为0时取shard.count配置，配置也为0时取进程可用的CPU数
+   * @param name 分片名前缀，分片i的调度器名为name_i
+   *
+   * shard.pin_cpu为true时分片i的线程绑定到进程可用的第i % n个CPU上，
+   * scheduler.affinity中配置了分片调度器名称的按配置放置。
+   */
+  explicit ShardGroup(size_t count = 0, const std::string& name = "shard");
+
+  /**
+   * @brief 停止所有服务器和分片
+   */
+  ~ShardGroup();
+
+  size_t size() const { return m_shards.size(); }
+
+  IOManager* getShard(size_t i) const { return m_shards[i].get(); }
+
+  const std::string& getName() const { return m_name; }
+
+  /**
+   * @brief 当前线程所在分片的下标，不在分片线程上返回-1
+   */
+  static int GetCurrentIndex();
+
+  /**
+   * @brief 当前线程所在的分片组，不在分片线程上返回nullptr
+   */
+  static ShardGroup* GetCurrent();
+
+  /**
+   * @brief 把cb投递到分片shard执行，不等待结果
+   */
+  void post(size_t shard, std::function<void()> cb) {
+    m_shards[shard]->schedule(std::move(cb));
+  }
+
+  /**
+   * @brief 在分片shard上执行f，返回它的结果
+   *
+   * 在分片的协程中get只挂起当前协程，结果回来之后在原来的分片上继续。
+   */
+  template <class F>
+  auto call(size_t shard, F&& f) {
+    return Async(m_shards[shard].get(), std::forward<F>(f));
+  }
+
+  /**
+   * @brief 在每个分片上执行f(分片下标)，全部执行完时返回的Future完成
+   */
+  Future<void> broadcast(std::function<void(size_t)> f);
+
+  /**
+   * @brief 在每个分片上启动一个服务器，监听同一组地址
+   *
+   * 先绑定分片0，其他分片绑定分片0实际绑定到的地址，端口为0时所有分片监听同一个端口
+   * @param factory 为分片创建服务器，服务器的worker和accept_worker都应该是这个分片
+   * @return 全部绑定并启动成功返回true，否则停止已经启动的服务器并返回false
+   */
+  bool serve(const std::vector<Address::sptr>& addrs,
+             const ServerFactory& factory);
+
+  /**
+   * @brief serve启动的服务器，下标对应分片
+   */
+  const std::vector<TcpServer::sptr>& getServers() const { return m_servers; }
+
+  /**
+   * @brief 停止所有服务器和分片，等待分片线程退出，不能在分片线程上调用
+   */
+  void stop();
+
+ private:
+  std::string m_name;
+  std::vector<std::unique_ptr<IOManager>> m_shards;  ///< 分片，每个一个线程
+  std::vector<TcpServer::sptr> m_servers;            ///< serve启动的服务器
+  bool m_stopped{false};
+};
+
+}  // namespace East
@@ -63,6 +63,10 @@ class Socket : public std::enable_shared_from_this<Socket>, noncopyable {
 
   bool init(int sock);
 
+  /// @brief 设置SO_REUSEPORT，多个socket绑定同一个地址，由内核把新连接分给它们
+  /// 需要在bind之前调用
+  void setReusePort(bool v);
+
   bool bind(const Address::sptr addr);
 
   bool connect(const Address::sptr addr, uint64_t timeout_ms = -1);
@@ -135,6 +139,7 @@ class Socket : public std::enable_shared_from_this<Socket>, noncopyable {
   int m_type{0};
   int m_protocol{0};
   bool m_is_connected{false};
+  bool m_reuse_port{false};
   Address::sptr m_local_addr{nullptr};
   Address::sptr m_remote_addr{nullptr};
 };
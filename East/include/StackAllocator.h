@@ -0,0 +1,94 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 10:12:31
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 10:12:31
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace East {
+
+/**
+ * @brief 协程栈分配器接口
+ *
+ * Fiber通过该接口申请/归还协程栈，默认实现由配置fiber.stack_allocator决定：
+ * - malloc: 直接使用malloc/free
+ * - mmap:   每个线程维护一个空闲栈链表，栈底带PROT_NONE保护页，栈溢出会直接触发SIGSEGV
+ */
+class StackAllocator {
+ public:
+  virtual ~StackAllocator() {}
+
+  /**
+   * @brief 申请一块协程栈
+   * @param size 栈大小（字节）
+   * @return 栈的起始地址（低地址），失败返回nullptr
+   */
+  virtual void* alloc(size_t size) = 0;
+
+  /**
+   * @brief 归还协程栈
+   * @param p alloc返回的地址
+   * @param size 申请时的大小
+   */
+  virtual void dealloc(void* p, size_t size) = 0;
+
+  /**
+   * @brief 栈的低地址处是否有保护页，栈溢出时能立即发现
+   */
+  virtual bool hasGuardPage() const { return false; }
+
+  /**
+   * @brief 获取当前默认的栈分配器
+   */
+  static StackAllocator* GetDefault();
+
+  /**
+   * @brief 替换默认的栈分配器，传nullptr恢复为配置指定的分配器
+   * @note 分配器对象需要比所有使用它的协程活得更久
+   */
+  static void SetDefault(StackAllocator* allocator);
+};
+
+/**
+ * @brief 基于malloc的栈分配器，没有保护页也没有缓存
+ */
+class MallocStackAllocator : public StackAllocator {
+ public:
+  void* alloc(size_t size) override;
+  void dealloc(void* p, size_t size) override;
+};
+
+/**
+ * @brief 基于mmap的池化栈分配器
+ *
+ * - 每个线程按栈大小维护空闲链表，命中时不需要任何系统调用
+ * - 每个栈的低地址处有一个PROT_NONE保护页
+ * - 可选地在栈进入空闲链表时MADV_DONTNEED，把物理内存还给内核
+ */
+class MmapStackAllocator : public StackAllocator {
+ public:
+  /**
+   * @brief 统计信息
+   */
+  struct Stats {
+    uint64_t hits{0};            ///< 从空闲链表中直接拿到栈的次数
+    uint64_t misses{0};          ///< 需要新mmap的次数
+    uint64_t mapped_bytes{0};    ///< 当前映射的栈总大小（不含保护页）
+    uint64_t cached_bytes{0};    ///< 空闲链表中的栈总大小
+    uint64_t resident_bytes{0};  ///< 未被MADV_DONTNEED的栈大小（常驻内存上界）
+  };
+
+  void* alloc(size_t size) override;
+  void dealloc(void* p, size_t size) override;
+  bool hasGuardPage() const override { return true; }
+
+  static Stats GetStats();
+  static std::string StatsToString();
+};
+
+}  // namespace East
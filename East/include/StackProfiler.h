@@ -0,0 +1,91 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 12:20:05
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 12:20:05
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <typeinfo>
+
+namespace East {
+
+/**
+ * @brief 协程栈使用量采样与栈大小自动调优
+ *
+ * 打开fiber.stack_profile后：
+ * - 每fiber.stack_profile_rate个新建或复用的协程采样一个，其余的协程不做任何处理
+ * - 被采样协程的栈只在栈顶下方的窗口（最大档位再多一页）内填充毒化字节
+ * - 协程TERM时从窗口底部向上找到第一个被改写的位置，得到栈的最高水位，超出窗口的按窗口大小记录
+ * - 采样结果按协程函数的类型（调度时传入的lambda/bind对象，基本对应调用点）分组，
+ *   每个调用点的统计都是原子变量，采样时不加锁
+ *
+ * 再打开fiber.stack_autotune后，未指定栈大小的协程会按调用点的最高水位
+ * 加上余量选择32K/64K/128K/256K中最小的档位，样本不足或者用得深的调用点仍使用fiber.stack_size。
+ * 选择的档位在采样时算好发布出来，创建协程时不加锁读取；
+ * 调小的栈只有在默认分配器带保护页时才会使用，否则总是使用fiber.stack_size
+ */
+class StackProfiler {
+ public:
+  /**
+   * @brief 栈大小档位数量，最后一档表示超过256K（使用默认栈大小）
+   */
+  static constexpr size_t kClassCount = 5;
+
+  /**
+   * @brief 是否在采样栈使用量（fiber.stack_profile或fiber.stack_autotune）
+   */
+  static bool IsEnabled();
+
+  /**
+   * @brief 当前线程新建或复用的协程是否需要采样，按fiber.stack_profile_rate抽样
+   */
+  static bool ShouldSample();
+
+  /**
+   * @brief 为调用点选择栈大小
+   * @param site 协程函数的类型
+   * @param default_size 默认栈大小
+   * @return 自动调优关闭、默认分配器没有保护页或者样本不足时返回default_size
+   */
+  static uint32_t ChooseStackSize(const std::type_info& site,
+                                  uint32_t default_size);
+
+  /**
+   * @brief 用毒化字节填充[p, p + size)中靠近高地址、不超过采样窗口的部分
+   */
+  static void Poison(void* p, size_t size);
+
+  /**
+   * @brief 计算栈的最高水位
+   * @param stack 栈的低地址
+   * @param size 栈大小
+   * @return 从栈顶算起被改写过的字节数，最多到采样窗口的大小
+   */
+  static size_t Measure(const void* stack, size_t size);
+
+  /**
+   * @brief 记录一次采样
+   * @param site 协程函数的类型
+   * @param used 栈使用量
+   * @param stack_size 协程实际的栈大小
+   * @param default_size 默认栈大小
+   */
+  static void Record(const std::type_info& site, size_t used,
+                     size_t stack_size, uint32_t default_size);
+
+  /**
+   * @brief 输出每个调用点的采样次数、最高水位、选择的档位以及按档位统计的直方图
+   */
+  static std::string Dump();
+
+  /**
+   * @brief 清空所有采样结果
+   */
+  static void Reset();
+};
+
+}  // namespace East
@@ -85,12 +85,41 @@ class TcpServer : public std::enable_shared_from_this<TcpServer>,
    */
   void setReadTimeout(uint64_t v) { m_readTimeout = v; }
 
+  /**
+   * @brief 客户端连接是否在共享栈上处理
+   */
+  bool isSharedStack() const { return m_sharedStack; }
+
+  /**
+   * @brief 设置客户端连接是否在共享栈上处理，只影响之后接受的连接
+   * @param v 是否使用共享栈
+   */
+  void setSharedStack(bool v) { m_sharedStack = v; }
+
+  /**
+   * @brief 监听socket是否设置SO_REUSEPORT
+   */
+  bool isReusePort() const { return m_reusePort; }
+
+  /**
+   * @brief 设置监听socket是否设置SO_REUSEPORT，需要在bind之前调用
+   *
+   * 多个服务器绑定同一个地址，由内核把新连接分给各自的监听socket
+   * @param v 是否设置SO_REUSEPORT
+   */
+  void setReusePort(bool v) { m_reusePort = v; }
+
   /**
    * @brief 设置服务器名称
    * @param name 服务器名称
    */
   void setName(const std::string& name) { m_name = name; }
 
+  /**
+   * @brief 获取监听socket列表，顺序和bind传入的地址一致
+   */
+  const std::vector<Socket::sptr>& getSocks() const { return m_socks; }
+
   /**
    * @brief 检查服务器是否已停止
    * @return 服务器已停止返回true，运行中返回false
@@ -115,6 +144,8 @@ class TcpServer : public std::enable_shared_from_this<TcpServer>,
   IOManager* m_acceptWorker{nullptr};  ///< 接受连接协程管理器，监听新连接
   std::vector<Socket::sptr> m_socks;  ///< 监听socket列表
   uint64_t m_readTimeout{0};  ///< 读取超时时间，防止资源浪费
+  bool m_sharedStack{false};  ///< 客户端连接是否在共享栈上处理
+  bool m_reusePort{false};    ///< 监听socket是否设置SO_REUSEPORT
 
   std::string m_name;    ///< 服务器名称
   bool m_isStop{false};  ///< 服务器停止标志
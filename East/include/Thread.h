@@ -10,6 +10,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include "Mutex.h"
 #include "Noncopyable.h"
 
@@ -18,7 +19,12 @@ namespace East {
 class Thread : private noncopymoveable {
  public:
   using sptr = std::shared_ptr<Thread>;
-  Thread(const std::string& name, std::function<void()> cb);
+  /**
+   * @param cpus 线程绑定的CPU，为空时不限制。线程创建时就绑定好，
+   *             之后在线程里第一次访问的内存（栈、线程本地的缓存、malloc分配的对象）都落在这些CPU所在的NUMA节点上
+   */
+  Thread(const std::string& name, std::function<void()> cb,
+         const std::vector<int>& cpus = {});
   ~Thread();
 
   pid_t getId();
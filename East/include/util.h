@@ -33,6 +33,31 @@ uint64_t GetCurrentTimeInUs();
 
 std::string TimeSinceEpochToString(uint64_t tm);
 
+//demangle c++ symbol name, return name itself on failure
+std::string Demangle(const char* name);
+
+//parse a cpu list like "0-3,8" in the given order without duplicates,
+//return empty on malformed input
+std::vector<int> ParseCpuList(const std::string& str);
+
+//format cpus as a cpu list like "0-3,8"
+std::string CpuListToString(const std::vector<int>& cpus);
+
+//pin thread tid (0 means the calling thread) to cpus
+bool SetThreadAffinity(pid_t tid, const std::vector<int>& cpus);
+
+//cpus thread tid (0 means the calling thread) is allowed to run on
+std::vector<int> GetThreadAffinity(pid_t tid);
+
+//cpu thread tid last ran on, -1 on failure
+int GetThreadCpu(pid_t tid);
+
+//numa node of cpu read from sysfs, -1 if unknown
+int GetNumaNodeOfCpu(int cpu);
+
+//cpus of numa node read from sysfs, empty if the node does not exist
+std::vector<int> GetNumaNodeCpus(int node);
+
 template <typename T>
 auto Enum2Utype(T e) -> std::underlying_type_t<T> {
   return static_cast<std::underlying_type_t<T>>(e);
@@ -0,0 +1,133 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 15:50:51
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 15:50:51
+ */
+
+#include "Cancellation.h"
+#include "FiberLocal.h"
+#include "IOManager.h"
+#include "Macro.h"
+
+namespace East {
+
+//当前协程绑定的令牌，协程结束或复用时随协程局部变量一起释放
+static FiberLocal<CancellationToken::sptr> t_token;
+
+CancellationToken::sptr CancellationToken::Create() {
+  return sptr(new CancellationToken());
+}
+
+CancellationToken::~CancellationToken() {
+  if (nullptr != m_parent && 0 != m_parentCallbackId) {
+    m_parent->removeCallback(m_parentCallbackId);
+  }
+  if (nullptr != m_timer) {
+    m_timer->cancel();
+  }
+}
+
+CancellationToken::sptr CancellationToken::createChild() {
+  sptr child = Create();
+  child->m_parent = shared_from_this();
+  std::weak_ptr<CancellationToken> weak_child(child);
+  child->m_parentCallbackId = addCallback([weak_child]() {
+    sptr c = weak_child.lock();
+    if (nullptr != c) {
+      c->cancel();
+    }
+  });
+  return child;
+}
+
+void CancellationToken::cancel() {
+  if (m_cancelled.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  std::map<uint64_t, std::function<void()>> callbacks;
+  Timer::sptr timer;
+  {
+    SpinLock::LockGuard lock(m_mutex);
+    callbacks.swap(m_callbacks);
+    timer.swap(m_timer);
+  }
+  if (nullptr != timer) {
+    timer->cancel();
+  }
+  for (auto& i : callbacks) {
+    i.second();
+  }
+}
+
+void CancellationToken::cancelAfter(uint64_t ms) {
+  IOManager* io_mgr = IOManager::GetThis();
+  EAST_ASSERT2(nullptr != io_mgr, "cancelAfter needs an IOManager");
+  std::weak_ptr<CancellationToken> weak_self(shared_from_this());
+  Timer::sptr timer = io_mgr->addTimer(ms, [weak_self]() {
+    sptr self = weak_self.lock();
+    if (nullptr != self) {
+      self->cancel();
+    }
+  });
+  {
+    SpinLock::LockGuard lock(m_mutex);
+    if (!isCancelled()) {
+      timer.swap(m_timer);  //换下之前的定时器
+    }
+  }
+  if (nullptr != timer) {
+    timer->cancel();
+  }
+}
+
+uint64_t CancellationToken::addCallback(std::function<void()> cb) {
+  {
+    SpinLock::LockGuard lock(m_mutex);
+    //cancel先置标志再取回调，这里看到未取消，回调一定会被cancel执行
+    if (!isCancelled()) {
+      uint64_t id = m_nextId++;
+      m_callbacks.emplace(id, std::move(cb));
+      return id;
+    }
+  }
+  cb();
+  return 0;
+}
+
+void CancellationToken::removeCallback(uint64_t id) {
+  if (0 == id) {
+    return;
+  }
+  SpinLock::LockGuard lock(m_mutex);
+  m_callbacks.erase(id);
+}
+
+std::function<void()> CancellationToken::bind(std::function<void()> cb) {
+  sptr child = createChild();
+  return [child, cb]() {
+    sptr old = GetThis();
+    SetThis(child);
+    cb();
+    SetThis(old);
+  };
+}
+
+CancellationToken::sptr CancellationToken::GetThis() {
+  return t_token.has() ? *t_token : nullptr;
+}
+
+void CancellationToken::SetThis(sptr token) {
+  if (nullptr != token) {
+    t_token.emplace(std::move(token));
+  } else {
+    t_token.reset();
+  }
+}
+
+std::function<void()> CancellationToken::Bind(std::function<void()> cb) {
+  sptr cur = GetThis();
+  return nullptr != cur ? cur->bind(std::move(cb)) : cb;
+}
+
+}  // namespace East
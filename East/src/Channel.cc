@@ -0,0 +1,147 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 14:30:15
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 14:30:15
+ */
+
+#include "Channel.h"
+#include <algorithm>
+#include "IOManager.h"
+#include "Macro.h"
+
+namespace East {
+
+void ChannelBase::close() {
+  std::vector<ChannelWaiter::sptr> wakes;
+  {
+    SpinLock::LockGuard lock(m_lock);
+    if (m_closed) {
+      return;
+    }
+    m_closed = true;
+    for (auto q : {&m_recvq, &m_sendq}) {
+      while (ChannelOp::sptr op = PopWaiterLocked(*q)) {
+        op->ok = false;
+        wakes.push_back(op->waiter);
+      }
+    }
+  }
+  for (auto& w : wakes) {
+    Wake(w);
+  }
+}
+
+ChannelOp::sptr ChannelBase::PopWaiterLocked(std::deque<ChannelOp::sptr>& q) {
+  while (!q.empty()) {
+    ChannelOp::sptr op = std::move(q.front());
+    q.pop_front();
+    if (op->waiter->tryFire(op->index)) {
+      return op;
+    }
+  }
+  return nullptr;
+}
+
+void ChannelBase::LockAll(const std::vector<ChannelBase*>& chans) {
+  for (auto c : chans) {
+    c->m_lock.lock();
+  }
+}
+
+void ChannelBase::UnlockAll(const std::vector<ChannelBase*>& chans) {
+  for (auto it = chans.rbegin(); it != chans.rend(); ++it) {
+    (*it)->m_lock.unlock();
+  }
+}
+
+void ChannelBase::enqueueLocked(const ChannelOp::sptr& op) {
+  (op->is_send ? m_sendq : m_recvq).push_back(op);
+}
+
+void ChannelBase::removeLocked(const ChannelWaiter* waiter) {
+  for (auto q : {&m_recvq, &m_sendq}) {
+    q->erase(std::remove_if(q->begin(), q->end(),
+                            [waiter](const ChannelOp::sptr& op) {
+                              return op->waiter.get() == waiter;
+                            }),
+             q->end());
+  }
+}
+
+int Select(const std::vector<ChannelOp::sptr>& cases, int64_t timeout_ms) {
+  EAST_ASSERT(!cases.empty());
+  std::vector<ChannelBase*> chans;
+  for (auto& op : cases) {
+    chans.push_back(op->channel);
+  }
+  //按地址顺序加锁，避免两个Select互相等锁
+  std::sort(chans.begin(), chans.end());
+  chans.erase(std::unique(chans.begin(), chans.end()), chans.end());
+
+  //先不挂起地试一遍，有就绪的直接返回
+  ChannelWaiter::sptr wake;
+  ChannelBase::LockAll(chans);
+  for (size_t i = 0; i < cases.size(); ++i) {
+    if (cases[i]->channel->tryOpLocked(cases[i].get(), wake)) {
+      ChannelBase::UnlockAll(chans);
+      ChannelBase::Wake(wake);
+      cases[i]->finish();
+      return i;
+    }
+  }
+  if (0 == timeout_ms) {
+    ChannelBase::UnlockAll(chans);
+    return -1;
+  }
+
+  //挂到每个通道的等待队列上，由对端、close或者定时器抢完成权
+  Semaphore sem;
+  auto waiter = std::make_shared<ChannelWaiter>();
+  waiter->node = FiberParker::Prepare(&sem);
+  for (size_t i = 0; i < cases.size(); ++i) {
+    cases[i]->index = i;
+    cases[i]->waiter = waiter;
+    cases[i]->channel->enqueueLocked(cases[i]);
+  }
+  ChannelBase::UnlockAll(chans);
+
+  Timer::sptr timer;
+  if (timeout_ms > 0) {
+    IOManager* iom = IOManager::GetThis();
+    EAST_ASSERT2(nullptr != iom, "channel timeout needs an IOManager");
+    ChannelWaiter* w = waiter.get();
+    timer = iom->addConditionTimer(
+        timeout_ms,
+        [w]() {
+          if (w->tryFire(ChannelWaiter::kTimeout)) {
+            FiberParker::Wake(w->node);
+          }
+        },
+        waiter);
+  }
+
+  FiberParker::Park(waiter->node, "channel");
+
+  if (nullptr != timer) {
+    timer->cancel();
+  }
+  //没有完成的case还挂在其他通道上
+  ChannelBase::LockAll(chans);
+  for (auto c : chans) {
+    c->removeLocked(waiter.get());
+  }
+  ChannelBase::UnlockAll(chans);
+  for (auto& op : cases) {
+    op->waiter = nullptr;
+  }
+
+  int fired = waiter->fired.load(std::memory_order_acquire);
+  if (fired < 0) {
+    return -1;
+  }
+  cases[fired]->finish();
+  return fired;
+}
+
+}  // namespace East
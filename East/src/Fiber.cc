@@ -6,11 +6,19 @@
  */
 
 #include "Fiber.h"
+#include <stdlib.h>
+#include <string.h>
 #include <atomic>
+#include <sstream>
+#include <vector>
 #include "Config.h"
 #include "Elog.h"
 #include "Macro.h"
+#include "Mutex.h"
 #include "Scheduler.h"
+#include "StackAllocator.h"
+#include "StackProfiler.h"
+#include "util.h"
 
 namespace East {
 
@@ -18,6 +26,7 @@ static Logger::sptr g_logger = ELOG_NAME("system");
 
 static std::atomic<uint64_t> s_fiber_id{0};
 static std::atomic<uint64_t> s_fiber_count{0};
+static std::atomic<size_t> s_local_key{0};
 
 static thread_local Fiber* t_fiber{nullptr};  //当前正在执行的协程
 static thread_local Fiber::sptr t_master_fiber{
@@ -26,14 +35,128 @@ static thread_local Fiber::sptr t_master_fiber{
 static ConfigVar<uint32_t>::sptr g_fiber_stack_size = Config::Lookup<uint32_t>(
     "fiber.stack_size", 1024 * 1024, "fiber stack size");
 
-class MallocStackAllocator {
- public:
-  static void* Alloc(size_t size) { return malloc(size); }
+static ConfigVar<uint32_t>::sptr g_fiber_pool_size = Config::Lookup<uint32_t>(
+    "fiber.pool_size", 64, "max recycled fibers per thread");
 
-  static void Dealloc(void* p, size_t size) { return free(p); }
+static std::atomic<uint64_t> s_pool_hits{0};
+static std::atomic<uint64_t> s_pool_misses{0};
+static std::atomic<uint64_t> s_pool_recycled{0};
+static std::atomic<uint64_t> s_pool_pooled{0};
+
+//线程私有的空闲协程链表，里面的协程都是TERM状态，栈和上下文都保留着
+struct FiberPool {
+  std::vector<Fiber::sptr> fibers;
+
+  ~FiberPool() { s_pool_pooled -= fibers.size(); }
+};
+
+static thread_local FiberPool t_fiber_pool;
+
+static ConfigVar<uint32_t>::sptr g_fiber_shared_stack_count =
+    Config::Lookup<uint32_t>("fiber.shared_stack_count", 4,
+                             "shared stacks per thread");
+
+static ConfigVar<uint32_t>::sptr g_fiber_shared_stack_size =
+    Config::Lookup<uint32_t>("fiber.shared_stack_size", 1024 * 1024,
+                             "shared stack size");
+
+//共享栈，同一时刻只有owner的栈内容在上面，其他协程的栈内容保存在各自的m_save_buf中
+struct SharedStack {
+  void* stack{nullptr};
+  size_t size{0};
+  StackAllocator* allocator{nullptr};
+  Fiber* owner{nullptr};
+};
+
+//线程私有的共享栈，第一次使用时才申请
+struct SharedStackPool {
+  std::vector<SharedStack*> stacks;
+  size_t next{0};
+  size_t bound{0};  //绑定在这个线程上、还没结束的协程数
+
+  //优先选择空闲的共享栈，都被占用时轮流换下
+  SharedStack* get() {
+    if (stacks.empty()) {
+      uint32_t count = g_fiber_shared_stack_count->getValue();
+      count = count > 0 ? count : 1;
+      for (uint32_t i = 0; i < count; ++i) {
+        SharedStack* s = new SharedStack;
+        s->size = g_fiber_shared_stack_size->getValue();
+        s->allocator = StackAllocator::GetDefault();
+        s->stack = s->allocator->alloc(s->size);
+        EAST_ASSERT2(s->stack, "alloc shared stack failed");
+        stacks.push_back(s);
+      }
+    }
+    for (auto s : stacks) {
+      if (nullptr == s->owner) {
+        return s;
+      }
+    }
+    SharedStack* s = stacks[next];
+    next = (next + 1) % stacks.size();
+    return s;
+  }
+
+  ~SharedStackPool() {
+    for (auto s : stacks) {
+      s->allocator->dealloc(s->stack, s->size);
+      delete s;
+    }
+  }
 };
 
-using StackAllocator = MallocStackAllocator;  //you can use other malloc method
+static thread_local SharedStackPool t_shared_stacks;
+
+//每个线程一个存活协程的链表，协程创建和销毁时只锁自己所在的链表，导出时逐个遍历
+struct FiberRegistry {
+  SpinLock mutex;
+  Fiber* head{nullptr};
+  FiberRegistry* next{nullptr};  //所有链表串在一起，只增不减
+};
+
+//所有线程的协程链表，线程退出后链表留给新线程复用，里面可能还有存活的协程
+struct RegistryList {
+  Mutex mutex;
+  FiberRegistry* head{nullptr};
+  std::vector<FiberRegistry*> idle;
+};
+
+static RegistryList& GetRegistryList() {
+  static RegistryList* s_list = new RegistryList;  //其他编译单元静态初始化时也可能创建协程，不析构
+  return *s_list;
+}
+
+struct ThreadRegistry {
+  FiberRegistry* registry{nullptr};
+
+  ~ThreadRegistry() {
+    if (nullptr != registry) {
+      RegistryList& l = GetRegistryList();
+      Mutex::LockGuard lock(l.mutex);
+      l.idle.push_back(registry);
+    }
+  }
+};
+
+static thread_local ThreadRegistry t_registry;
+
+static FiberRegistry* GetRegistry() {
+  if (nullptr == t_registry.registry) {
+    RegistryList& l = GetRegistryList();
+    Mutex::LockGuard lock(l.mutex);
+    if (!l.idle.empty()) {
+      t_registry.registry = l.idle.back();
+      l.idle.pop_back();
+    } else {
+      FiberRegistry* r = new FiberRegistry;
+      r->next = l.head;
+      l.head = r;
+      t_registry.registry = r;
+    }
+  }
+  return t_registry.registry;
+}
 
 //主协程的构造函数, private funcion，只会在GetThis中调用
 Fiber::Fiber() {
@@ -41,8 +164,8 @@ Fiber::Fiber() {
   SetThis(this);
 
   //主协程的上下文就是当前运行的上下文
-  if (getcontext(&m_ctx)) {
-    EAST_ASSERT2(false, "getcontext");
+  if (!m_ctx.init()) {
+    EAST_ASSERT2(false, "init context");
   }
 
   ++s_fiber_count;
@@ -50,32 +173,49 @@ Fiber::Fiber() {
                       << ", thread id: " << GetThreadId();  //main fiber id is 0
 }
 
-Fiber::Fiber(std::function<void()> cb, size_t stack_size, bool run_in_scheduler)
-    : m_id(++s_fiber_id), m_cb(cb), m_run_in_scheduler(run_in_scheduler) {
+Fiber::Fiber(InlineTask cb, size_t stack_size, bool run_in_scheduler,
+             bool shared_stack)
+    : m_id(++s_fiber_id),
+      m_cb(std::move(cb)),
+      m_run_in_scheduler(run_in_scheduler),
+      m_shared_stack(shared_stack),
+      m_site(&m_cb.target_type()) {
 
   ++s_fiber_count;
-  //没有指定的话，读配置
-  m_stacksize = stack_size != 0 ? stack_size : g_fiber_stack_size->getValue();
-
-  m_stack = StackAllocator::Alloc(m_stacksize);
-
-  if (getcontext(&m_ctx)) {
-    EAST_ASSERT2(false, "getcontext");
+  registerSelf();
+#if !defined(__x86_64__) && !defined(__aarch64__)
+  m_shared_stack = false;  //拿不到切出时的栈顶，退回独立栈
+#endif
+  if (m_shared_stack) {
+    //栈在第一次resume时才确定，上下文也推迟到那时创建
+    m_ctx_pending = true;
+    ELOG_DEBUG(g_logger) << "Fiber created, id: " << m_id
+                         << ", thread id: " << GetThreadId()
+                         << ", shared stack";
+    return;
   }
 
-  // if (!use_caller) {
-  //   m_ctx.uc_link = &t_master_fiber->m_ctx;  //diff
-  // } else {
-  //   m_ctx.uc_link = &Scheduler::GetMainFiber()->m_ctx;  //diff
-  // }
-
-  //这个协程时需要运行我们指定的函数，我们需要申请额外的空间
-  m_ctx.uc_link = nullptr;
-  m_ctx.uc_stack.ss_sp = m_stack;
-  m_ctx.uc_stack.ss_size = m_stacksize;
+  //没有指定的话，读配置，打开了栈大小自动调优时按调用点选择
+  m_stacksize = stack_size != 0
+                    ? stack_size
+                    : StackProfiler::ChooseStackSize(
+                          *m_site, g_fiber_stack_size->getValue());
+
+  //记录下分配器，保证释放时和申请时是同一个
+  m_allocator = StackAllocator::GetDefault();
+  m_stack = m_allocator->alloc(m_stacksize);
+  EAST_ASSERT2(m_stack, "alloc fiber stack failed");
+
+  //抽中采样的协程才毒化栈顶的窗口
+  if (StackProfiler::ShouldSample()) {
+    StackProfiler::Poison(m_stack, m_stacksize);
+    m_poisoned = m_sampled = true;
+  }
 
-  //设置协程函数
-  makecontext(&m_ctx, &Fiber::MainFunc, 0);
+  //在申请的栈上设置协程函数
+  if (!m_ctx.make(m_stack, m_stacksize, &Fiber::MainFunc)) {
+    EAST_ASSERT2(false, "make context");
+  }
 
   //setState(INIT);
   ELOG_DEBUG(g_logger) << "Fiber created, id: " << m_id
@@ -85,11 +225,20 @@ Fiber::Fiber(std::function<void()> cb, size_t stack_size, bool run_in_scheduler)
 
 Fiber::~Fiber() {
   --s_fiber_count;
+  if (m_stack || m_shared_stack) {
+    unregisterSelf();  //先从链表中摘掉，导出时不会碰到正在释放的栈
+  }
+  clearLocals();
   bool is_master_fiber = false;
-  if (m_stack) {
+  if (m_shared_stack) {
     EAST_ASSERT2(m_state == TERM || m_state == INIT || m_state == EXCEPT,
                  m_state);
-    StackAllocator::Dealloc(m_stack, m_stacksize);
+    EAST_ASSERT(nullptr == m_shared);  //结束时已经归还了共享栈
+    free(m_save_buf);
+  } else if (m_stack) {
+    EAST_ASSERT2(m_state == TERM || m_state == INIT || m_state == EXCEPT,
+                 m_state);
+    m_allocator->dealloc(m_stack, m_stacksize);
   } else {
     EAST_ASSERT(!m_cb);
     EAST_ASSERT(m_state == EXEC);
@@ -111,39 +260,71 @@ Fiber::~Fiber() {
 }
 
 //重置协程函数，并重置状态（当前状态：INIT/TERM)
-void Fiber::reset(std::function<void()> cb) {
-  EAST_ASSERT(m_stack);  //不能是主协程
+void Fiber::reset(InlineTask cb) {
+  EAST_ASSERT(m_stack || m_shared_stack);  //不能是主协程
   EAST_ASSERT(m_state == TERM || m_state == INIT);
 
-  m_cb = cb;
-  if (getcontext(&m_ctx)) {
-    EAST_ASSERT2(false, "getcontext");
+  m_cb = std::move(cb);
+  m_site = &m_cb.target_type();
+  m_deadline = 0;
+  m_group = 0;
+  clearLocals();
+  if (m_shared_stack) {
+    m_ctx_pending = true;
+    setState(INIT);
+    return;
+  }
+  m_sampled = StackProfiler::ShouldSample();
+  if (m_sampled && !m_poisoned) {
+    StackProfiler::Poison(m_stack, m_stacksize);  //上次没有采样，窗口已经被用脏了
+    m_poisoned = true;
+  }
+  if (!m_ctx.make(m_stack, m_stacksize, &Fiber::MainFunc)) {
+    EAST_ASSERT2(false, "make context");
   }
-
-  m_ctx.uc_link = nullptr;
-  m_ctx.uc_stack.ss_sp = m_stack;
-  m_ctx.uc_stack.ss_size = m_stacksize;
-
-  makecontext(&m_ctx, &Fiber::MainFunc, 0);
   setState(INIT);
 }
 
 void Fiber::resume() {
   EAST_ASSERT2(m_state != EXEC, m_state);  //TODO
-  SetThis(this);                           //该协程切换到当前协程
+  if (m_shared_stack) {
+    claimSharedStack();
+  }
+  SetThis(this);  //该协程切换到当前协程
   setState(EXEC);
+  m_wait.reason = nullptr;
+  if (m_run_in_scheduler) {
+    Scheduler* scheduler = Scheduler::GetThis();
+    m_scheduler_id.store(nullptr != scheduler ? scheduler->getId() : 0,
+                         std::memory_order_relaxed);
+  }
 
   if (!m_run_in_scheduler) {
-    if (swapcontext(&t_master_fiber->m_ctx,
-                    &m_ctx)) {  //old context, new context
-      EAST_ASSERT2(false, "swapcontext: master fiber to cur fiber failed.");
+    if (!t_master_fiber->m_ctx.swap(m_ctx)) {  //old context, new context
+      EAST_ASSERT2(false, "swap context: master fiber to cur fiber failed.");
     }
   } else {
-    if (swapcontext(&Scheduler::GetMainFiber()->m_ctx,
-                    &m_ctx)) {  //old context, new context
-      EAST_ASSERT2(false, "swapcontext: scheduler fiber to cur fiber failed.");
+    if (!Scheduler::GetMainFiber()->m_ctx.swap(m_ctx)) {  //old context, new context
+      EAST_ASSERT2(false, "swap context: scheduler fiber to cur fiber failed.");
     }
   }
+  if (m_state == TERM || m_state == EXCEPT) {
+    clearLocals();  //在调用者的栈上析构协程局部变量
+  }
+  if (m_shared_stack && (m_state == TERM || m_state == EXCEPT)) {
+    releaseSharedStack();
+  }
+  if (m_sampled && (m_state == TERM || m_state == EXCEPT)) {
+    //采样之后只需要把用过的部分重新毒化，协程复用时不用再填充整个窗口
+    size_t used = StackProfiler::Measure(m_stack, m_stacksize);
+    StackProfiler::Record(*m_site, used, m_stacksize,
+                          g_fiber_stack_size->getValue());
+    StackProfiler::Poison(static_cast<char*>(m_stack) + m_stacksize - used,
+                          used);
+    m_sampled = false;
+  } else if (m_state == TERM || m_state == EXCEPT) {
+    m_poisoned = false;  //没有采样的运行把窗口用脏了
+  }
   // ELOG_DEBUG(g_logger) << "Fiber resumed, id: " << m_id
   //             << ", thread id: " << GetThreadId() << ", state: " << m_state << ", m_run_in_caller: " << m_run_in_scheduler
   //             << ", master fiber addr: " << t_master_fiber.get() << ", cur fiber addr: " << this
@@ -152,10 +333,6 @@ void Fiber::resume() {
 
 void Fiber::yield() {
   //EAST_ASSERT2(m_state == EXEC, m_state);
-  ELOG_DEBUG(ELOG_ROOT()) << "m_run_int_scheduler: " << m_run_in_scheduler
-                          << ", cur id: " << m_id << ", main fiber id: "
-                          << Scheduler::GetMainFiber()->getId()
-                          << ", master fiber id: " << t_master_fiber->getId();
   if (m_run_in_scheduler)
     SetThis(Scheduler::GetMainFiber());
   else
@@ -165,15 +342,152 @@ void Fiber::yield() {
   // }
 
   if (!m_run_in_scheduler) {
-    if (swapcontext(&m_ctx,
-                    &t_master_fiber->m_ctx)) {  //old context, new context
-      EAST_ASSERT2(false, "swapcontext: cur fiber to master fiber failed.");
+    if (!m_ctx.swap(t_master_fiber->m_ctx)) {  //old context, new context
+      EAST_ASSERT2(false, "swap context: cur fiber to master fiber failed.");
+    }
+  } else {
+    if (!m_ctx.swap(Scheduler::GetMainFiber()->m_ctx)) {  //old context, new context
+      EAST_ASSERT2(false, "swap context: cur fiber to scheduler fiber failed.");
     }
+  }
+}
+
+//resume之前调用，此时运行在调度协程（或主协程）的栈上，共享栈上的协程都已切出
+void Fiber::claimSharedStack() {
+  if (nullptr == m_shared) {
+    m_shared = t_shared_stacks.get();
+    m_bound_thread = GetThreadId();
+    ++t_shared_stacks.bound;
+  }
+  EAST_ASSERT2(m_bound_thread == GetThreadId(),
+               "shared stack fiber resumed on another thread");
+  EAST_ASSERT2(nullptr == t_fiber || t_fiber->m_shared != m_shared,
+               "resume shared stack fiber from the same shared stack");
+
+  Fiber* owner = m_shared->owner;
+  if (owner != this) {
+    if (nullptr != owner) {
+      owner->saveSharedStack();
+    }
+    m_shared->owner = this;
+    if (!m_ctx_pending && m_save_size > 0) {
+      char* top = static_cast<char*>(m_shared->stack) + m_shared->size;
+      memcpy(top - m_save_size, m_save_buf, m_save_size);
+      m_save_size = 0;
+    }
+  }
+  if (m_ctx_pending) {
+    if (!m_ctx.make(m_shared->stack, m_shared->size, &Fiber::MainFunc)) {
+      EAST_ASSERT2(false, "make context");
+    }
+    m_ctx_pending = false;
+  }
+}
+
+void Fiber::saveSharedStack() {
+  char* top = static_cast<char*>(m_shared->stack) + m_shared->size;
+  char* sp = static_cast<char*>(m_ctx.stackPointer());
+  EAST_ASSERT2(sp >= static_cast<char*>(m_shared->stack) && sp <= top,
+               "stack pointer out of shared stack");
+
+  size_t used = top - sp;
+  if (used > m_save_cap) {
+    free(m_save_buf);
+    m_save_buf = static_cast<char*>(malloc(used));
+    EAST_ASSERT2(m_save_buf, "alloc shared stack save buffer failed");
+    m_save_cap = used;
+  }
+  memcpy(m_save_buf, sp, used);
+  m_save_size = used;
+}
+
+void Fiber::releaseSharedStack() {
+  if (m_shared->owner == this) {
+    m_shared->owner = nullptr;
+  }
+  m_shared = nullptr;
+  m_bound_thread = -1;
+  m_save_size = 0;
+  --t_shared_stacks.bound;
+}
+
+void Fiber::registerSelf() {
+  m_registry = GetRegistry();
+  FiberRegistry& r = *m_registry;
+  SpinLock::LockGuard lock(r.mutex);
+  m_next = r.head;
+  if (nullptr != r.head) {
+    r.head->m_prev = this;
+  }
+  r.head = this;
+}
+
+void Fiber::unregisterSelf() {
+  //协程可能在别的线程上销毁，从加入时的链表中摘掉
+  FiberRegistry& r = *m_registry;
+  SpinLock::LockGuard lock(r.mutex);
+  if (nullptr != m_prev) {
+    m_prev->m_next = m_next;
   } else {
-    if (swapcontext(
-            &m_ctx,
-            &Scheduler::GetMainFiber()->m_ctx)) {  //old context, new context
-      EAST_ASSERT2(false, "swapcontext: cur fiber to scheduler fiber failed.");
+    r.head = m_next;
+  }
+  if (nullptr != m_next) {
+    m_next->m_prev = m_prev;
+  }
+  m_prev = m_next = nullptr;
+}
+
+size_t Fiber::backtrace(void** frames, size_t max) const {
+#if EAST_FIBER_ASM_CONTEXT
+  //共享栈上的内容随时可能被换出，只回溯独立栈
+  State state = m_state;
+  if (0 == max || m_shared_stack || nullptr == m_stack ||
+      (state != HOLD && state != READY)) {
+    return 0;
+  }
+  uintptr_t lo = reinterpret_cast<uintptr_t>(m_stack);
+  uintptr_t hi = lo + m_stacksize;
+  uintptr_t sp = reinterpret_cast<uintptr_t>(m_ctx.stackPointer());
+#if defined(__x86_64__)
+  const size_t kFp = 6, kPc = 7;  //east_context_swap保存的rbp和返回地址
+#else
+  const size_t kFp = 18, kPc = 19;  //x29和x30
+#endif
+  if (sp < lo || sp + (kPc + 1) * sizeof(uintptr_t) > hi) {
+    return 0;
+  }
+  const uintptr_t* regs = reinterpret_cast<const uintptr_t*>(sp);
+  size_t n = 0;
+  frames[n++] = reinterpret_cast<void*>(regs[kPc]);
+  uintptr_t fp = regs[kFp];
+  //协程可能在回溯过程中被恢复，每一步都检查帧指针还在自己的栈内
+  while (n < max && fp >= sp && fp + 2 * sizeof(uintptr_t) <= hi &&
+         0 == (fp & (sizeof(uintptr_t) - 1))) {
+    const uintptr_t* frame = reinterpret_cast<const uintptr_t*>(fp);
+    if (0 == frame[1]) {
+      break;
+    }
+    frames[n++] = reinterpret_cast<void*>(frame[1]);
+    if (frame[0] <= fp) {
+      break;
+    }
+    fp = frame[0];
+  }
+  return n;
+#else
+  (void)frames;
+  (void)max;
+  return 0;
+#endif
+}
+
+void Fiber::clearLocals() {
+  //析构函数里可能又用到协程局部变量，先整体换出来
+  std::vector<LocalSlot> locals;
+  locals.swap(m_locals);
+  for (auto& slot : locals) {
+    if (nullptr != slot.value && nullptr != slot.destroy) {
+      slot.destroy(slot.value);
     }
   }
 }
@@ -212,6 +526,103 @@ void Fiber::YieldToHold() {
   cur_fiber->yield();
 }
 
+Fiber::sptr Fiber::Create(InlineTask cb, size_t stack_size,
+                          bool run_in_scheduler, bool shared_stack) {
+#if !defined(__x86_64__) && !defined(__aarch64__)
+  shared_stack = false;
+#endif
+  uint32_t size = 0;
+  if (!shared_stack) {
+    size = stack_size != 0
+               ? stack_size
+               : StackProfiler::ChooseStackSize(cb.target_type(),
+                                                g_fiber_stack_size->getValue());
+  }
+
+  auto& fibers = t_fiber_pool.fibers;
+  for (auto it = fibers.rbegin(); it != fibers.rend(); ++it) {
+    Fiber::sptr& f = *it;
+    if (f->m_shared_stack == shared_stack && f->m_stacksize == size &&
+        f->m_run_in_scheduler == run_in_scheduler) {
+      Fiber::sptr fiber;
+      fiber.swap(f);
+      fibers.erase(std::next(it).base());
+      --s_pool_pooled;
+      ++s_pool_hits;
+
+      fiber->m_id = ++s_fiber_id;  //复用的协程也当作新协程，方便日志里区分
+      fiber->reset(std::move(cb));
+      return fiber;
+    }
+  }
+
+  ++s_pool_misses;
+  return std::make_shared<Fiber>(std::move(cb), size, run_in_scheduler,
+                                 shared_stack);
+}
+
+void Fiber::Recycle(Fiber::sptr& f) {
+  if (nullptr == f || f->m_state != TERM || f.use_count() != 1 ||
+      (nullptr == f->m_stack && !f->m_shared_stack)) {
+    f.reset();
+    return;
+  }
+  auto& fibers = t_fiber_pool.fibers;
+  if (fibers.size() >= g_fiber_pool_size->getValue()) {
+    f.reset();
+    return;
+  }
+  fibers.emplace_back(std::move(f));
+  ++s_pool_pooled;
+  ++s_pool_recycled;
+}
+
+Fiber::PoolStats Fiber::GetPoolStats() {
+  PoolStats stats;
+  stats.hits = s_pool_hits;
+  stats.misses = s_pool_misses;
+  stats.recycled = s_pool_recycled;
+  stats.pooled = s_pool_pooled;
+  return stats;
+}
+
+std::string Fiber::PoolStatsToString() {
+  PoolStats stats = GetPoolStats();
+  uint64_t total = stats.hits + stats.misses;
+  std::stringstream ss;
+  ss << "hits: " << stats.hits << ", misses: " << stats.misses
+     << ", hit rate: " << (total ? stats.hits * 100.0 / total : 0.0) << "%"
+     << ", recycled: " << stats.recycled << ", pooled: " << stats.pooled;
+  return ss.str();
+}
+
+size_t Fiber::AllocLocalKey() {
+  return s_local_key++;
+}
+
+void* Fiber::GetLocal(size_t key) {
+  Fiber* cur = t_fiber;
+  if (nullptr == cur) {
+    cur = GetThis().get();
+  }
+  return key < cur->m_locals.size() ? cur->m_locals[key].value : nullptr;
+}
+
+void Fiber::SetLocal(size_t key, void* value, void (*destroy)(void*)) {
+  Fiber* cur = t_fiber;
+  if (nullptr == cur) {
+    cur = GetThis().get();
+  }
+  if (key >= cur->m_locals.size()) {
+    cur->m_locals.resize(key + 1);
+  }
+  LocalSlot old = cur->m_locals[key];
+  cur->m_locals[key] = {value, destroy};
+  if (nullptr != old.value && old.value != value && nullptr != old.destroy) {
+    old.destroy(old.value);
+  }
+}
+
 uint64_t Fiber::TotalFibers() {
   return s_fiber_count;
 }
@@ -220,6 +631,45 @@ uint64_t Fiber::GetFiberId() {
   return nullptr == t_fiber ? 0 : t_fiber->m_id;
 }
 
+uint64_t Fiber::CurrentDeadline() {
+  return nullptr == t_fiber ? 0 : t_fiber->m_deadline;
+}
+
+bool Fiber::HasBoundFibers() {
+  return t_shared_stacks.bound > 0;
+}
+
+int Fiber::CurrentGroup() {
+  return nullptr == t_fiber ? 0 : t_fiber->m_group;
+}
+
+void Fiber::SetWaitReason(const char* reason, int fd, int event) {
+  if (nullptr == t_fiber) {
+    return;
+  }
+  WaitInfo& w = t_fiber->m_wait;
+  w.fd = fd;
+  w.event = event;
+  w.since = GetCurrentTimeInMs();
+  w.reason = reason;
+}
+
+void Fiber::ForEach(const std::function<void(const Fiber&)>& cb) {
+  FiberRegistry* head = nullptr;
+  {
+    RegistryList& l = GetRegistryList();
+    Mutex::LockGuard lock(l.mutex);
+    head = l.head;
+  }
+  //链表只增不减，拿到表头之后不用再持有全局锁
+  for (FiberRegistry* r = head; nullptr != r; r = r->next) {
+    SpinLock::LockGuard lock(r->mutex);
+    for (Fiber* f = r->head; nullptr != f; f = f->m_next) {
+      cb(*f);
+    }
+  }
+}
+
 void Fiber::MainFunc() {
   Fiber::sptr cur_fiber = GetThis();
   EAST_ASSERT(cur_fiber);
@@ -0,0 +1,165 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 11:03:12
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 11:03:12
+ */
+
+#include "FiberContext.h"
+#include <stdint.h>
+#include <string.h>
+
+#if EAST_FIBER_ASM_CONTEXT
+#if defined(__x86_64__)
+//System V AMD64: callee-saved为rbx, rbp, r12-r15, 另外保存mxcsr和x87控制字
+//栈布局（从低到高）: [mxcsr|fpucw] r15 r14 r13 r12 rbx rbp ret
+asm(R"(
+    .pushsection .text
+    .globl east_context_swap
+    .type east_context_swap, @function
+    .align 16
+east_context_swap:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    subq $8, %rsp
+    stmxcsr (%rsp)
+    fnstcw 4(%rsp)
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+    ldmxcsr (%rsp)
+    fldcw 4(%rsp)
+    addq $8, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size east_context_swap, .-east_context_swap
+
+    .globl east_context_entry
+    .type east_context_entry, @function
+    .align 16
+east_context_entry:
+    callq *%rbx
+    ud2
+    .size east_context_entry, .-east_context_entry
+    .popsection
+)");
+#elif defined(__aarch64__)
+//AAPCS64: callee-saved为x19-x28, x29(fp), x30(lr), d8-d15
+//栈布局（从低到高）: d8-d15 x19-x28 x29 x30
+asm(R"(
+    .pushsection .text
+    .globl east_context_swap
+    .type east_context_swap, %function
+    .align 4
+east_context_swap:
+    sub sp, sp, #0xa0
+    stp d8, d9, [sp, #0x00]
+    stp d10, d11, [sp, #0x10]
+    stp d12, d13, [sp, #0x20]
+    stp d14, d15, [sp, #0x30]
+    stp x19, x20, [sp, #0x40]
+    stp x21, x22, [sp, #0x50]
+    stp x23, x24, [sp, #0x60]
+    stp x25, x26, [sp, #0x70]
+    stp x27, x28, [sp, #0x80]
+    stp x29, x30, [sp, #0x90]
+    mov x9, sp
+    str x9, [x0]
+    mov sp, x1
+    ldp d8, d9, [sp, #0x00]
+    ldp d10, d11, [sp, #0x10]
+    ldp d12, d13, [sp, #0x20]
+    ldp d14, d15, [sp, #0x30]
+    ldp x19, x20, [sp, #0x40]
+    ldp x21, x22, [sp, #0x50]
+    ldp x23, x24, [sp, #0x60]
+    ldp x25, x26, [sp, #0x70]
+    ldp x27, x28, [sp, #0x80]
+    ldp x29, x30, [sp, #0x90]
+    add sp, sp, #0xa0
+    ret
+    .size east_context_swap, .-east_context_swap
+
+    .globl east_context_entry
+    .type east_context_entry, %function
+    .align 4
+east_context_entry:
+    blr x19
+    brk #0
+    .size east_context_entry, .-east_context_entry
+    .popsection
+)");
+#endif
+#endif
+
+namespace East {
+
+bool UContext::init() {
+  return 0 == getcontext(&m_ctx);
+}
+
+bool UContext::make(void* stack, size_t size, void (*fn)()) {
+  if (getcontext(&m_ctx)) {
+    return false;
+  }
+  m_ctx.uc_link = nullptr;
+  m_ctx.uc_stack.ss_sp = stack;
+  m_ctx.uc_stack.ss_size = size;
+  makecontext(&m_ctx, fn, 0);
+  return true;
+}
+
+bool UContext::swap(UContext& to) {
+  return 0 == swapcontext(&m_ctx, &to.m_ctx);
+}
+
+void* UContext::stackPointer() const {
+#if defined(__x86_64__)
+  return reinterpret_cast<void*>(m_ctx.uc_mcontext.gregs[REG_RSP]);
+#elif defined(__aarch64__)
+  return reinterpret_cast<void*>(m_ctx.uc_mcontext.sp);
+#else
+  return nullptr;
+#endif
+}
+
+#if EAST_FIBER_ASM_CONTEXT
+bool AsmContext::make(void* stack, size_t size, void (*fn)()) {
+  if (nullptr == stack || nullptr == fn) {
+    return false;
+  }
+  uintptr_t top = reinterpret_cast<uintptr_t>(stack) + size;
+  top &= ~static_cast<uintptr_t>(15);  //栈顶16字节对齐
+
+#if defined(__x86_64__)
+  //ret进入east_context_entry时rsp要16字节对齐，这样call fn之后就和普通函数调用一致，
+  //所以返回地址放在top-24，最上面的8字节空着
+  void** sp = reinterpret_cast<void**>(top - 80);
+  memset(sp, 0, 80);
+  uint32_t* fpu = reinterpret_cast<uint32_t*>(sp);
+  fpu[0] = 0x1F80;                   //mxcsr默认值
+  fpu[1] = 0x037F;                   //x87控制字默认值
+  sp[5] = reinterpret_cast<void*>(fn);  //rbx
+  sp[6] = nullptr;                      //rbp, 回溯时作为栈帧链的终点
+  sp[7] = reinterpret_cast<void*>(&east_context_entry);  //返回地址
+#elif defined(__aarch64__)
+  void** sp = reinterpret_cast<void**>(top - 0xa0);
+  memset(sp, 0, 0xa0);
+  sp[8] = reinterpret_cast<void*>(fn);                    //x19
+  sp[18] = nullptr;                                       //x29
+  sp[19] = reinterpret_cast<void*>(&east_context_entry);  //x30
+#endif
+  m_sp = sp;
+  return true;
+}
+#endif
+
+}  // namespace East
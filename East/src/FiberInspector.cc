@@ -0,0 +1,216 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 17:35:15
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 17:35:15
+ */
+
+#include "FiberInspector.h"
+#include <execinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <sstream>
+#include "IOManager.h"
+#include "util.h"
+
+namespace East {
+
+static constexpr size_t kMaxFrames = 32;
+
+//在协程链表的锁内只拷贝原始字段，查调度器名称和符号化都放到锁外做
+struct RawFiberInfo {
+  uint64_t id{0};
+  Fiber::State state{Fiber::INIT};
+  uint64_t scheduler_id{0};
+  bool shared_stack{false};
+  uint32_t stack_size{0};
+  Fiber::WaitInfo wait;
+  const std::type_info* site{nullptr};
+  void* frames[kMaxFrames];
+  size_t frame_count{0};
+};
+
+//把backtrace_symbols的结果"binary(symbol+0x10) [0x...]"中的符号demangle
+static std::string Symbolize(const char* line) {
+  std::string s(line);
+  size_t begin = s.find('(');
+  size_t end = s.find('+', begin);
+  if (std::string::npos == begin || std::string::npos == end ||
+      end == begin + 1) {
+    return s;
+  }
+  return s.substr(0, begin + 1) +
+         Demangle(s.substr(begin + 1, end - begin - 1).c_str()) +
+         s.substr(end);
+}
+
+static const char* EventToString(int event) {
+  switch (event) {
+    case IOManager::READ:
+      return "READ";
+    case IOManager::WRITE:
+      return "WRITE";
+    default:
+      return "NONE";
+  }
+}
+
+static std::string JsonEscape(const std::string& s) {
+  std::string res;
+  res.reserve(s.size());
+  for (char c : s) {
+    switch (c) {
+      case '"':
+        res += "\\\"";
+        break;
+      case '\\':
+        res += "\\\\";
+        break;
+      case '\n':
+        res += "\\n";
+        break;
+      case '\t':
+        res += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", c);
+          res += buf;
+        } else {
+          res += c;
+        }
+    }
+  }
+  return res;
+}
+
+const char* FiberInspector::StateToString(Fiber::State state) {
+  switch (state) {
+    case Fiber::INIT:
+      return "INIT";
+    case Fiber::HOLD:
+      return "HOLD";
+    case Fiber::EXEC:
+      return "EXEC";
+    case Fiber::TERM:
+      return "TERM";
+    case Fiber::READY:
+      return "READY";
+    case Fiber::EXCEPT:
+      return "EXCEPT";
+  }
+  return "UNKNOWN";
+}
+
+std::vector<FiberInfo> FiberInspector::Collect(bool parked_only,
+                                               bool with_backtrace) {
+  uint64_t now = GetCurrentTimeInMs();
+  std::vector<RawFiberInfo> raws;
+  raws.reserve(Fiber::TotalFibers());
+  Fiber::ForEach([&](const Fiber& f) {
+    Fiber::State state = f.getState();
+    if (parked_only && state != Fiber::HOLD) {
+      return;
+    }
+    raws.emplace_back();
+    RawFiberInfo& raw = raws.back();
+    raw.id = f.getId();
+    raw.state = state;
+    raw.scheduler_id = f.getSchedulerId();
+    raw.shared_stack = f.isSharedStack();
+    raw.stack_size = f.getStackSize();
+    raw.wait = f.getWaitInfo();
+    raw.site = f.getSite();
+    if (with_backtrace) {
+      raw.frame_count = f.backtrace(raw.frames, kMaxFrames);
+    }
+  });
+
+  std::vector<FiberInfo> res;
+  res.reserve(raws.size());
+  for (auto& raw : raws) {
+    FiberInfo info;
+    info.id = raw.id;
+    info.state = raw.state;
+    //调度器可能已经析构，按id查不到时留空
+    if (0 != raw.scheduler_id) {
+      Scheduler::GetNameById(raw.scheduler_id, info.scheduler);
+    }
+    info.shared_stack = raw.shared_stack;
+    info.stack_size = raw.stack_size;
+    if (nullptr != raw.wait.reason && raw.state == Fiber::HOLD) {
+      info.wait_reason = raw.wait.reason;
+      info.fd = raw.wait.fd;
+      info.event = raw.wait.event;
+      info.parked_ms = now > raw.wait.since ? now - raw.wait.since : 0;
+    }
+    if (nullptr != raw.site) {
+      info.site = Demangle(raw.site->name());
+    }
+    if (raw.frame_count > 0) {
+      char** symbols = backtrace_symbols(raw.frames, raw.frame_count);
+      if (nullptr != symbols) {
+        for (size_t i = 0; i < raw.frame_count; ++i) {
+          info.backtrace.push_back(Symbolize(symbols[i]));
+        }
+        free(symbols);
+      }
+    }
+    res.push_back(std::move(info));
+  }
+  std::stable_sort(res.begin(), res.end(),
+                   [](const FiberInfo& a, const FiberInfo& b) {
+                     return a.parked_ms > b.parked_ms;
+                   });
+  return res;
+}
+
+std::string FiberInspector::DumpText(bool parked_only, bool with_backtrace) {
+  std::vector<FiberInfo> fibers = Collect(parked_only, with_backtrace);
+  std::stringstream ss;
+  ss << "fibers: " << fibers.size() << "\n";
+  for (auto& f : fibers) {
+    ss << "fiber " << f.id << " " << StateToString(f.state);
+    if (!f.wait_reason.empty()) {
+      ss << " on " << f.wait_reason;
+      if (-1 != f.fd) {
+        ss << "(fd: " << f.fd << ", event: " << EventToString(f.event) << ")";
+      }
+      ss << " for " << f.parked_ms << "ms";
+    }
+    ss << "\n    scheduler: " << (f.scheduler.empty() ? "-" : f.scheduler)
+       << ", stack: " << (f.shared_stack ? "shared" : std::to_string(f.stack_size))
+       << "\n    site: " << f.site << "\n";
+    for (auto& frame : f.backtrace) {
+      ss << "    #" << &frame - &f.backtrace[0] << " " << frame << "\n";
+    }
+  }
+  return ss.str();
+}
+
+std::string FiberInspector::DumpJson(bool parked_only, bool with_backtrace) {
+  std::vector<FiberInfo> fibers = Collect(parked_only, with_backtrace);
+  std::stringstream ss;
+  ss << "[";
+  for (size_t i = 0; i < fibers.size(); ++i) {
+    const FiberInfo& f = fibers[i];
+    ss << (0 == i ? "" : ",") << "{\"id\":" << f.id << ",\"state\":\""
+       << StateToString(f.state) << "\",\"scheduler\":\""
+       << JsonEscape(f.scheduler) << "\",\"site\":\"" << JsonEscape(f.site)
+       << "\",\"shared_stack\":" << (f.shared_stack ? "true" : "false")
+       << ",\"stack_size\":" << f.stack_size << ",\"wait_reason\":\""
+       << JsonEscape(f.wait_reason) << "\",\"fd\":" << f.fd
+       << ",\"event\":\"" << EventToString(f.event)
+       << "\",\"parked_ms\":" << f.parked_ms << ",\"backtrace\":[";
+    for (size_t j = 0; j < f.backtrace.size(); ++j) {
+      ss << (0 == j ? "" : ",") << "\"" << JsonEscape(f.backtrace[j]) << "\"";
+    }
+    ss << "]}";
+  }
+  ss << "]";
+  return ss.str();
+}
+
+}  // namespace East
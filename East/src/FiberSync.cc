@@ -0,0 +1,222 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 13:40:20
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 13:40:20
+ */
+
+#include "FiberSync.h"
+#include "Scheduler.h"
+
+namespace East {
+
+Fiber::WaitNode* FiberParker::Prepare(Semaphore* sem) {
+  Fiber::sptr cur = Fiber::GetThis();
+  Scheduler* scheduler = Scheduler::GetThis();
+  Fiber::WaitNode* node = cur->getWaitNode();
+  //只有由调度器恢复的任务协程可以让出，调度协程和主协程让出后没有人能把它们换回来
+  if (nullptr != scheduler && cur->isRunInScheduler() &&
+      cur.get() != Scheduler::GetMainFiber()) {
+    node->fiber = cur;  //挂起期间由节点持有协程，唤醒时交给调度器
+    node->scheduler = scheduler;
+    node->sem = nullptr;
+  } else {
+    node->fiber = nullptr;
+    node->scheduler = nullptr;
+    node->sem = sem;
+  }
+  node->next = nullptr;
+  return node;
+}
+
+void FiberParker::Park(Fiber::WaitNode* node, const char* reason) {
+  if (nullptr != node->sem) {
+    node->sem->wait();
+  } else {
+    Fiber::SetWaitReason(reason);
+    Fiber::YieldToHold();
+  }
+}
+
+void FiberParker::Wake(Fiber::WaitNode* node) {
+  //先把内容取出来，被唤醒的执行流可能马上复用这个节点
+  Semaphore* sem = node->sem;
+  if (nullptr != sem) {
+    sem->notify();
+    return;
+  }
+  Fiber::sptr fiber = std::move(node->fiber);
+  Scheduler* scheduler = node->scheduler;
+  scheduler->schedule(std::move(fiber));
+}
+
+void FiberMutex::lockSlow() {
+  Semaphore sem;
+  while (true) {
+    m_waitLock.lock();
+    //置为2之后解锁方一定会来唤醒，返回0说明锁刚被释放，直接拿到
+    if (0 == m_state.exchange(2, std::memory_order_acquire)) {
+      m_waitLock.unlock();
+      return;
+    }
+    Fiber::WaitNode* node = FiberParker::Prepare(&sem);
+    m_waiters.push(node);
+    m_waitLock.unlock();
+    FiberParker::Park(node, "mutex");
+  }
+}
+
+void FiberMutex::wakeOne() {
+  m_waitLock.lock();
+  Fiber::WaitNode* node = m_waiters.pop();
+  m_waitLock.unlock();
+  if (nullptr != node) {
+    FiberParker::Wake(node);
+  }
+}
+
+void FiberRWLock::lockSlow(bool writer) {
+  Semaphore sem;
+  bool woken = false;
+  SpinLock::LockGuard lock(m_waitLock);
+  while (true) {
+    uint32_t s = m_state.load(std::memory_order_relaxed);
+    //被唤醒的读者不用再给排队的写者让路，否则会和写者互相等待
+    bool can_lock = writer ? 0 == (s & (kWriter | kReaderMask))
+                           : 0 == (s & kWriter) && (woken || m_waiters.empty());
+    if (can_lock) {
+      uint32_t n = writer ? (s | kWriter) : (s + 1);
+      if (!m_state.compare_exchange_weak(s, n, std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+        continue;
+      }
+      if (m_waiters.empty() && (n & kWaiters)) {
+        m_state.fetch_and(~kWaiters, std::memory_order_relaxed);
+      }
+      return;
+    }
+    if (0 == (s & kWaiters)) {
+      //先让解锁方看到有等待者，再检查一次，避免错过在这之前的解锁
+      m_state.fetch_or(kWaiters, std::memory_order_acq_rel);
+      continue;
+    }
+    Fiber::WaitNode* node = FiberParker::Prepare(&sem);
+    node->data = writer ? 1 : 0;
+    m_waiters.push(node);
+    lock.unlock();
+    FiberParker::Park(node, "rwlock");
+    woken = true;
+    lock.lock();
+  }
+}
+
+void FiberRWLock::wakeSlow() {
+  FiberWaitQueue wake;
+  {
+    SpinLock::LockGuard lock(m_waitLock);
+    uint32_t s = m_state.load(std::memory_order_relaxed);
+    while (!m_waiters.empty()) {
+      if (1 == m_waiters.front()->data) {
+        //写者只在锁完全空闲时单独唤醒
+        if (wake.empty() && 0 == (s & (kWriter | kReaderMask))) {
+          wake.push(m_waiters.pop());
+        }
+        break;
+      }
+      wake.push(m_waiters.pop());
+    }
+    if (m_waiters.empty()) {
+      m_state.fetch_and(~kWaiters, std::memory_order_relaxed);
+    }
+  }
+  while (Fiber::WaitNode* node = wake.pop()) {
+    FiberParker::Wake(node);
+  }
+}
+
+void FiberCondVar::wait(FiberMutex& mutex) {
+  Semaphore sem;
+  m_waitLock.lock();
+  Fiber::WaitNode* node = FiberParker::Prepare(&sem);
+  m_waiters.push(node);
+  m_waitLock.unlock();
+  //入队之后再解锁，解锁之后的notify一定能看到这个节点
+  mutex.unlock();
+  FiberParker::Park(node, "condvar");
+  mutex.lock();
+}
+
+void FiberCondVar::notifyOne() {
+  m_waitLock.lock();
+  Fiber::WaitNode* node = m_waiters.pop();
+  m_waitLock.unlock();
+  if (nullptr != node) {
+    FiberParker::Wake(node);
+  }
+}
+
+void FiberCondVar::notifyAll() {
+  FiberWaitQueue wake;
+  m_waitLock.lock();
+  while (Fiber::WaitNode* node = m_waiters.pop()) {
+    wake.push(node);
+  }
+  m_waitLock.unlock();
+  while (Fiber::WaitNode* node = wake.pop()) {
+    FiberParker::Wake(node);
+  }
+}
+
+void FiberSemaphore::waitSlow() {
+  Semaphore sem;
+  m_waitLock.lock();
+  if (m_wakeups > 0) {  //notify已经先到了
+    --m_wakeups;
+    m_waitLock.unlock();
+    return;
+  }
+  Fiber::WaitNode* node = FiberParker::Prepare(&sem);
+  m_waiters.push(node);
+  m_waitLock.unlock();
+  FiberParker::Park(node, "semaphore");
+}
+
+void FiberSemaphore::notifySlow() {
+  m_waitLock.lock();
+  Fiber::WaitNode* node = m_waiters.pop();
+  if (nullptr == node) {  //等待者已经减了计数但还没入队，留给它自己取
+    ++m_wakeups;
+  }
+  m_waitLock.unlock();
+  if (nullptr != node) {
+    FiberParker::Wake(node);
+  }
+}
+
+void WaitGroup::waitSlow() {
+  Semaphore sem;
+  m_waitLock.lock();
+  //计数归零的done会在拿到m_waitLock之后才唤醒，这里看到非0就一定会被唤醒
+  if (0 == m_count.load(std::memory_order_acquire)) {
+    m_waitLock.unlock();
+    return;
+  }
+  Fiber::WaitNode* node = FiberParker::Prepare(&sem);
+  m_waiters.push(node);
+  m_waitLock.unlock();
+  FiberParker::Park(node, "waitgroup");
+}
+
+void WaitGroup::wakeAll() {
+  FiberWaitQueue wake;
+  m_waitLock.lock();
+  while (Fiber::WaitNode* node = m_waiters.pop()) {
+    wake.push(node);
+  }
+  m_waitLock.unlock();
+  while (Fiber::WaitNode* node = wake.pop()) {
+    FiberParker::Wake(node);
+  }
+}
+
+}  // namespace East
@@ -0,0 +1,68 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 15:10:31
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 15:10:31
+ */
+
+#include "Future.h"
+
+namespace East {
+
+void FutureStateBase::wait() {
+  if (isReady()) {
+    return;
+  }
+  Semaphore sem;
+  m_lock.lock();
+  if (isReady()) {
+    m_lock.unlock();
+    return;
+  }
+  Fiber::WaitNode* node = FiberParker::Prepare(&sem);
+  m_waiters.push(node);
+  m_lock.unlock();
+  FiberParker::Park(node, "future");
+}
+
+void FutureStateBase::onReady(std::function<void()> cb) {
+  {
+    SpinLock::LockGuard lock(m_lock);
+    if (!isReady()) {
+      m_callbacks.push_back(std::move(cb));
+      return;
+    }
+  }
+  cb();
+}
+
+void FutureStateBase::setException(std::exception_ptr e) {
+  SpinLock::LockGuard lock(m_lock);
+  checkUnsetLocked();
+  m_exception = e;
+  publish(lock);
+}
+
+void FutureStateBase::checkUnsetLocked() const {
+  if (isReady()) {
+    throw std::logic_error("promise already satisfied");
+  }
+}
+
+void FutureStateBase::publish(SpinLock::LockGuard& lock) {
+  m_ready.store(true, std::memory_order_release);
+  FiberWaitQueue waiters = m_waiters;
+  m_waiters = FiberWaitQueue();
+  std::vector<std::function<void()>> callbacks;
+  callbacks.swap(m_callbacks);
+  lock.unlock();
+
+  while (Fiber::WaitNode* node = waiters.pop()) {
+    FiberParker::Wake(node);
+  }
+  for (auto& cb : callbacks) {
+    cb();
+  }
+}
+
+}  // namespace East
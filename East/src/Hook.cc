@@ -7,6 +7,8 @@
 
 #include "Hook.h"
 #include <dlfcn.h>
+#include <atomic>
+#include "Cancellation.h"
 #include "Config.h"
 #include "FdManager.h"
 #include "Fiber.h"
@@ -64,9 +66,64 @@ void set_hook_enable(bool enable) {
 }
 
 struct timer_info {
-  int cancelled{0};
+  std::atomic<int> cancelled{0};  //超时(ETIMEDOUT)或者被取消(ECANCELED)，先到的生效
 };
 
+//当前协程的取消令牌取消时，和超时定时器一样通过cancelEvent把fd上等待的事件触发掉
+static uint64_t watch_cancel(const CancellationToken::sptr& token,
+                             std::weak_ptr<timer_info> weak_tinfo,
+                             IOManager* io_mgr, int fd, uint32_t event) {
+  if (nullptr == token) {
+    return 0;
+  }
+  return token->addCallback([weak_tinfo, io_mgr, fd, event]() {
+    auto shared_tinfo = weak_tinfo.lock();
+    int expected = 0;
+    if (nullptr == shared_tinfo ||
+        !shared_tinfo->cancelled.compare_exchange_strong(expected,
+                                                         ECANCELED)) {
+      return;
+    }
+    io_mgr->cancelEvent(fd, static_cast<IOManager::Event>(event));
+  });
+}
+
+//挂起当前协程ms毫秒，取消令牌取消时取消定时器提前唤醒，返回是否被取消
+static bool fiber_sleep(uint64_t ms) {
+  auto fiber = Fiber::GetThis();
+  auto io_mgr = IOManager::GetThis();
+  CancellationToken::sptr token = CancellationToken::GetThis();
+  if (nullptr != token && token->isCancelled()) {
+    return true;
+  }
+
+  uint64_t cancel_id = 0;
+  if (nullptr != fiber && nullptr != io_mgr) {
+    //定时器和取消只能有一个把协程放回调度器
+    auto woken = std::make_shared<std::atomic<bool>>(false);
+    Timer::sptr timer = io_mgr->addTimer(ms, [io_mgr, fiber, woken]() {
+      if (!woken->exchange(true)) {
+        io_mgr->schedule(fiber);
+      }
+    });
+    if (nullptr != token) {
+      cancel_id = token->addCallback([io_mgr, fiber, woken, timer]() {
+        if (!woken->exchange(true)) {
+          timer->cancel();
+          io_mgr->schedule(fiber);
+        }
+      });
+    }
+  }
+  Fiber::SetWaitReason("sleep");
+  fiber->yield();
+  if (nullptr != token) {
+    token->removeCallback(cancel_id);
+    return token->isCancelled();
+  }
+  return false;
+}
+
 //将非阻塞的IO调用函数改成协程异步调用，可以指定超时时间
 template <class OriginalFunc, class... OriginalFuncParams>
 ssize_t do_io(int fd, OriginalFunc func, const char* hook_func_name,
@@ -115,6 +172,13 @@ retry:
 
     auto io_mgr = East::IOManager::GetThis();
 
+    //当前请求已经取消了就不再等待
+    CancellationToken::sptr token = CancellationToken::GetThis();
+    if (nullptr != token && token->isCancelled()) {
+      errno = ECANCELED;
+      return -1;
+    }
+
     if (timeout != (uint64_t)-1) {
       //如果设置了超时时间，我们就添加一个条件定时器，在超时后取消这个事件
       std::weak_ptr<timer_info> weak_tinfo(tinfo);
@@ -122,10 +186,12 @@ retry:
           timeout,
           [io_mgr, weak_tinfo, fd, event] {
             auto shared_tinfo = weak_tinfo.lock();
-            if (nullptr == shared_tinfo || shared_tinfo->cancelled) {
+            int expected = 0;
+            if (nullptr == shared_tinfo ||
+                !shared_tinfo->cancelled.compare_exchange_strong(expected,
+                                                                 ETIMEDOUT)) {
               return;
             }
-            shared_tinfo->cancelled = ETIMEDOUT;
             if (nullptr != io_mgr) {
               io_mgr->cancelEvent(fd,
                                   static_cast<East::IOManager::Event>(event));
@@ -147,13 +213,17 @@ retry:
       }
       return -1;
     } else {
-      //添加成功了， 先让出执行权
+      //添加成功了，关联取消令牌，然后让出执行权
+      uint64_t cancel_id = watch_cancel(token, tinfo, io_mgr, fd, event);
       East::Fiber::YieldToHold();
 
       //恢复后取消定时器，说明没有超时
       if (nullptr != timer) {
         timer->cancel();
       }
+      if (nullptr != token) {
+        token->removeCallback(cancel_id);
+      }
 
       //检查这次resume是否是上面的条件定时器触发的
       if (tinfo->cancelled) {
@@ -180,22 +250,13 @@ unsigned int sleep(unsigned int seconds) {
     return sleep_f(seconds);
   }
 
-  auto fiber = East::Fiber::GetThis();
-  auto io_mgr = East::IOManager::GetThis();
-
   // auto func = std::bind(
   //   (void (East::IOManager::*)(East::Fiber::sptr, int thread_id))(&East::IOManager::schedule),
   //   io_mgr, fiber, -1);
 
-  if (nullptr != fiber && nullptr != io_mgr) {
-    io_mgr->addTimer(seconds * 1000, [io_mgr, fiber]() {
-      if (nullptr != io_mgr) {
-        io_mgr->schedule(fiber);
-      }
-    });
+  if (East::fiber_sleep(seconds * 1000ull)) {
+    return seconds;  //被取消，没有睡完
   }
-  //East::Fiber::YieldToHold();
-  fiber->yield();
   return 0u;
 }
 
@@ -203,19 +264,10 @@ int usleep(useconds_t usec) {
   if (!East::is_hook_enable()) {
     return usleep_f(usec);
   }
-  auto fiber = East::Fiber::GetThis();
-  auto io_mgr = East::IOManager::GetThis();
-
-  if (nullptr != fiber && nullptr != io_mgr) {
-    io_mgr->addTimer(usec / 1000, [io_mgr, fiber]() {
-      if (nullptr != io_mgr) {
-        io_mgr->schedule(fiber);
-      }
-    });
+  if (East::fiber_sleep(usec / 1000)) {
+    errno = ECANCELED;
+    return -1;
   }
-
-  //East::Fiber::YieldToHold();
-  fiber->yield();
   return 0;
 }
 
@@ -224,17 +276,10 @@ int nanosleep(const struct timespec* req, struct timespec* rem) {
     return nanosleep_f(req, rem);
   }
 
-  auto fiber = East::Fiber::GetThis();
-  auto io_mgr = East::IOManager::GetThis();
-  if (nullptr != fiber && nullptr != io_mgr) {
-    io_mgr->addTimer(req->tv_sec * 1000 + req->tv_nsec / 1000000,
-                     [io_mgr, fiber]() {
-                       if (nullptr != io_mgr) {
-                         io_mgr->schedule(fiber);
-                       }
-                     });
+  if (East::fiber_sleep(req->tv_sec * 1000 + req->tv_nsec / 1000000)) {
+    errno = ECANCELED;
+    return -1;
   }
-  fiber->yield();
   return 0;
 }
 
@@ -280,6 +325,11 @@ int connect_with_timeout(int fd, const struct sockaddr* addr, socklen_t addrlen,
   }
 
   auto io_mgr = East::IOManager::GetThis();
+  East::CancellationToken::sptr token = East::CancellationToken::GetThis();
+  if (nullptr != token && token->isCancelled()) {
+    errno = ECANCELED;
+    return -1;
+  }
   East::Timer::sptr timer{nullptr};
   std::shared_ptr<East::timer_info> tinfo =
       std::make_shared<East::timer_info>();
@@ -290,10 +340,12 @@ int connect_with_timeout(int fd, const struct sockaddr* addr, socklen_t addrlen,
         timeout,
         [io_mgr, weak_tinfo, fd] {
           auto shared_tinfo = weak_tinfo.lock();
-          if (nullptr == shared_tinfo || shared_tinfo->cancelled) {
+          int expected = 0;
+          if (nullptr == shared_tinfo ||
+              !shared_tinfo->cancelled.compare_exchange_strong(expected,
+                                                               ETIMEDOUT)) {
             return;
           }
-          shared_tinfo->cancelled = ETIMEDOUT;
           if (nullptr != io_mgr) {
             io_mgr->cancelEvent(fd, East::IOManager::WRITE);
           }
@@ -311,10 +363,15 @@ int connect_with_timeout(int fd, const struct sockaddr* addr, socklen_t addrlen,
     }
     return -1;
   } else {
+    uint64_t cancel_id = East::watch_cancel(token, tinfo, io_mgr, fd,
+                                            East::IOManager::WRITE);
     East::Fiber::GetThis()->yield();
     if (nullptr != timer) {
       timer->cancel();
     }
+    if (nullptr != token) {
+      token->removeCallback(cancel_id);
+    }
     if (tinfo->cancelled) {
       errno = tinfo->cancelled;
       return -1;
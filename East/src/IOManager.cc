@@ -8,11 +8,15 @@
 #include "IOManager.h"
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <string.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <time.h>
 #include <unistd.h>
 #include <algorithm>
 #include <functional>
+#include "Config.h"
 #include "Elog.h"
 #include "Macro.h"
 
@@ -23,6 +27,24 @@ namespace East {
  */
 static East::Logger::sptr g_logger = ELOG_NAME("system");
 
+static ConfigVar<uint32_t>::sptr g_iomanager_spin_us = Config::Lookup<uint32_t>(
+    "iomanager.spin_us", 50,
+    "max spin time(us) before an idle thread blocks in epoll, 0 to disable");
+
+static uint64_t NowInUs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+
+static inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
 /**
  * @brief 根据事件类型获取对应的上下文
  * @param event 事件类型（READ或WRITE）
@@ -86,10 +108,8 @@ void IOManager::FdContext::triggerEvent(IOManager::Event event) {
  * 
  * 初始化过程：
  * 1. 创建epoll实例
- * 2. 创建管道用于线程间通信
- * 3. 将管道读端添加到epoll监听
- * 4. 初始化文件描述符上下文数组
- * 5. 启动调度器
+ * 2. 初始化文件描述符上下文数组
+ * 3. 启动调度器，每个线程的唤醒eventfd在线程第一次进入idle时创建
  */
 IOManager::IOManager(size_t threads, bool use_caller, const std::string& name)
     : Scheduler(threads, use_caller, name) {
@@ -97,27 +117,12 @@ IOManager::IOManager(size_t threads, bool use_caller, const std::string& name)
   m_epfd = epoll_create1(0);
   EAST_ASSERT2(m_epfd != -1, "invalid epoll fd.");
 
-  // 创建管道用于线程间通信
-  int res = pipe(m_tickleFds);
-  EAST_ASSERT2(res == 0, "pipe failed.");
-
-  // 配置epoll事件，使用边缘触发模式
-  epoll_event ep_event{};
-  memset(&ep_event, 0, sizeof(ep_event));
-  ep_event.events = EPOLLIN | EPOLLET;
-  ep_event.data.fd = m_tickleFds[0];
-
-  // 设置管道读端为非阻塞模式
-  res = fcntl(m_tickleFds[0], F_SETFL, O_NONBLOCK);
-  EAST_ASSERT2(res == 0, "set pipe-0 non block failed.");
-
-  // 将管道读端添加到epoll监听
-  res = epoll_ctl(m_epfd, EPOLL_CTL_ADD, m_tickleFds[0], &ep_event);
-  EAST_ASSERT2(res == 0, "epoll ctl failed.");
-
   // 初始化文件描述符上下文数组
   contextResize(32);
 
+  // 每个线程的唤醒eventfd在线程第一次进入idle时创建
+  m_wakeFds.resize(kMaxThreads, -1);
+
   // 启动调度器
   start();
 }
@@ -128,15 +133,18 @@ IOManager::IOManager(size_t threads, bool use_caller, const std::string& name)
  * 清理过程：
  * 1. 停止调度器
  * 2. 关闭epoll文件描述符
- * 3. 关闭管道文件描述符
+ * 3. 关闭每个线程的唤醒eventfd
  * 4. 释放所有文件描述符上下文
  */
 IOManager::~IOManager() {
   stop();
   close(m_epfd);
-  close(m_tickleFds[0]);
-  close(m_tickleFds[1]);
-  m_epfd = m_tickleFds[0] = m_tickleFds[1] = -1;
+  m_epfd = -1;
+  for (int fd : m_wakeFds) {
+    if (-1 != fd) {
+      close(fd);
+    }
+  }
 
   // 释放所有文件描述符上下文
   for (size_t i = 0; i < m_fdContexts.size(); ++i) {
@@ -220,6 +228,7 @@ int IOManager::addEvent(int fd, Event event, std::function<void()> cb) {
     event_ctx.cb.swap(cb);
   } else {
     event_ctx.fiber = Fiber::GetThis();  // TODO: 使用当前协程
+    Fiber::SetWaitReason("io", fd, event);
   }
 
   ELOG_DEBUG(g_logger) << __FUNCTION__ << "epfd: " << m_epfd << ", fd: " << fd
@@ -473,16 +482,94 @@ bool IOManager::stopping(uint64_t& time_out) {
 /**
  * @brief 唤醒空闲线程
  * 
- * 通过管道向epoll写入数据来唤醒等待的线程
+ * 从阻塞线程的后进先出列表中取一个定向唤醒（合并已经在路上的唤醒）。
+ * 没有阻塞的线程时什么都不做：正要阻塞的线程进入阻塞列表之后会再看一次任务队列和定时器
  */
 void IOManager::tickle() {
+  // 和空闲线程阻塞之前检查队列配对：任务入队和线程进入空闲/自旋结束，总有一方看到另一方
+  std::atomic_thread_fence(std::memory_order_seq_cst);
   if (!hasIdleThreads())  // 如果没有空闲的线程，直接返回，没必要唤醒
     return;
 
-  // 约定：m_tickleFds[0]是读端，m_tickleFds[1]是发送端
-  // 在这里写入数据，其他线程在epoll_wait就可以读取到事件，从而达到唤醒的目的
-  int cnt = write(m_tickleFds[1], "t", 1);
-  EAST_ASSERT2(cnt == 1, "tickle pipe failed");
+  // 有线程在自旋时它自己会发现新任务，省掉一次唤醒。
+  if (m_spinningThreads > 0)
+    return;
+
+  wakeParkedWorker();
+}
+
+/**
+ * @brief 只唤醒指定的线程
+ *
+ * 写目标线程自己的eventfd，阻塞中的线程都在poll自己的eventfd，不会惊动其他线程
+ */
+void IOManager::tickleThread(size_t index) {
+  uint64_t one = 1;
+  int cnt = write(m_wakeFds[index], &one, sizeof(one));
+  EAST_ASSERT2(cnt == sizeof(one), "tickle thread eventfd failed");
+}
+
+/**
+ * @brief 当前线程的唤醒eventfd，第一次调用时创建
+ *
+ * 下标会给新线程复用，eventfd跟着下标走，IOManager析构时关闭
+ */
+int IOManager::getWakeFd() {
+  int index = getWorkerIndex();
+  EAST_ASSERT2(-1 != index, "no worker for this thread");
+  if (-1 == m_wakeFds[index]) {
+    m_wakeFds[index] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    EAST_ASSERT2(m_wakeFds[index] != -1, "eventfd failed.");
+  }
+  return m_wakeFds[index];
+}
+
+/**
+ * @brief 阻塞之前自旋，请求突发时新任务不用等唤醒
+ *
+ * 自旋时长按最近的情况调整：自旋等到了就加倍，没等到就减半，
+ * 减到0之后由阻塞等待的时长拉回来（见idle），所以空闲的系统不会一直空转。
+ * 同时自旋的线程不超过线程数的一半。
+ */
+bool IOManager::spinBeforePark(epoll_event* events, int max_events,
+                               uint64_t& budget_us, int& res) {
+  res = 0;
+  size_t max_spinning = std::max<size_t>(1, m_threadCount / 2);
+  if (0 == budget_us || m_spinningThreads.load() >= max_spinning) {
+    return false;
+  }
+  ++m_spinningThreads;
+  bool found = false;
+  uint64_t begin = NowInUs();
+  while (true) {
+    if (hasReadyTask()) {
+      found = true;
+      break;
+    }
+    res = epoll_wait(m_epfd, events, max_events, 0);
+    if (res > 0) {
+      found = true;
+      break;
+    }
+    res = 0;
+    if (NowInUs() - begin >= budget_us) {
+      break;
+    }
+    CpuRelax();
+  }
+  --m_spinningThreads;
+  //退出自旋之后再看一次，自旋期间tickle跳过了唤醒
+  if (!found && hasReadyTask()) {
+    found = true;
+  }
+
+  uint64_t max_us = g_iomanager_spin_us->getValue();
+  if (found) {
+    budget_us = std::min(max_us, budget_us * 2);
+  } else {
+    budget_us = budget_us / 2 < 2 ? 0 : budget_us / 2;
+  }
+  return found;
 }
 
 /**
@@ -502,6 +589,11 @@ void IOManager::idle() {
   // 使用智能指针管理epoll_event数组，避免内存泄漏
   std::unique_ptr<epoll_event[]> ep_events(new epoll_event[MAX_EVENTS]);
 
+  // 定向唤醒用的eventfd，只有本线程poll它
+  int wake_fd = getWakeFd();
+
+  uint64_t spin_budget = g_iomanager_spin_us->getValue();  // 本线程的自旋时长(us)
+
   while (true) {
     uint64_t next_timeout{0};
 
@@ -511,50 +603,121 @@ void IOManager::idle() {
       break;
     }
 
+    // 当前线程被选中退出
+    if (retiring()) {
+      break;
+    }
+
     int res{0};
+    bool poller = false;  // 这次阻塞时是否替所有线程等待epoll
+    int woken = 0;        // poll返回的就绪数
     do {
       constexpr int MAX_TIMEOUT = 3000;
 
+      if (next_timeout > 0) {
+        if (spinBeforePark(ep_events.get(), MAX_EVENTS, spin_budget, res)) {
+          break;
+        }
+        // 自旋期间插入到最前面的定时器没有唤醒任何线程，重新取一次超时时间
+        next_timeout = getNextTimer();
+      }
+
       // 看看现在最靠前的定时器是否小于这个超时时间，取较小的一个
       if (next_timeout != ~0ull)
         next_timeout = std::min(MAX_TIMEOUT, (int)next_timeout);
       else
         next_timeout = MAX_EVENTS;
 
-      ELOG_DEBUG(g_logger) << "epoll wait, timeout: " << next_timeout;
-      res = epoll_wait(m_epfd, ep_events.get(), MAX_EVENTS, (int)next_timeout);
+      // 线程数可以伸缩时定期回到调度循环检查负载
+      uint64_t interval = adjustInterval();
+      if (0 != interval) {
+        next_timeout = std::min(next_timeout, interval);
+      }
 
-      if (res < 0 && errno == EINTR) {
-        continue;
-      } else {
+      // 已经有可以取的任务时不阻塞，只取一次已经就绪的IO事件
+      if (!setParked(true)) {
+        res = epoll_wait(m_epfd, ep_events.get(), MAX_EVENTS, 0);
+        if (res < 0) {
+          res = 0;
+        }
         break;
       }
+      // 进入阻塞列表之前插到最前面的定时器和开始的停止没有唤醒任何线程，这里再看一次，
+      // 之后的tickle会唤醒阻塞的线程
+      uint64_t timer_timeout{0};
+      if (stopping(timer_timeout)) {
+        setParked(false);
+        break;
+      }
+      next_timeout = std::min(next_timeout, timer_timeout);
+
+      // 阻塞的线程都poll自己的eventfd，定向唤醒只惊动目标线程；
+      // 同一时刻只有一个阻塞的线程(poller)同时等epoll，IO事件只唤醒一个线程
+      poller = !m_polling.exchange(true);
+      pollfd fds[2];
+      fds[0].fd = wake_fd;
+      fds[0].events = POLLIN;
+      fds[0].revents = 0;
+      fds[1].fd = m_epfd;
+      fds[1].events = POLLIN;
+      fds[1].revents = 0;
+      ELOG_DEBUG(g_logger) << "poll, timeout: " << next_timeout
+                           << ", poller: " << poller;
+      uint64_t park_begin = NowInUs();
+      woken = poll(fds, poller ? 2 : 1, (int)next_timeout);
+      setParked(false);
+      if (poller) {
+        m_polling = false;
+      }
+
+      // 阻塞不久就被唤醒说明任务来得密，按这次阻塞的时长把自旋时长拉回来
+      uint64_t parked_us = NowInUs() - park_begin;
+      uint64_t max_spin = g_iomanager_spin_us->getValue();
+      if (woken > 0 && parked_us < max_spin) {
+        spin_budget = std::max(spin_budget, std::min(max_spin, parked_us * 2));
+      }
+
+      // 被其他信号打断时回到调度循环看一眼有没有任务
+      if (woken < 0) {
+        woken = 0;
+        break;
+      }
+      if (fds[0].revents & POLLIN) {
+        uint64_t dummy{};
+        while (read(wake_fd, &dummy, sizeof(dummy)) > 0)
+          ;
+      }
+      if (poller && (fds[1].revents & POLLIN)) {
+        res = epoll_wait(m_epfd, ep_events.get(), MAX_EVENTS, 0);
+        if (res < 0) {
+          res = 0;
+        }
+      }
+      break;
     } while (true);
 
     // 处理超时的定时器
     std::vector<std::function<void()>> timer_cbs{};
     listExpiredCb(timer_cbs);  // 获取所有已经超时的定时器的回调函数
-    if (!timer_cbs.empty()) {
+    bool has_timers = !timer_cbs.empty();
+    if (has_timers) {
       schedule(timer_cbs.begin(),
                timer_cbs.end());  // 将符合条件的timer的回调放进去
       timer_cbs.clear();
     }
 
+    // poller要去执行任务了，唤醒另一个阻塞的线程接着等epoll，
+    // 否则在它回来之前新的IO事件没有线程处理；什么都没等到的超时马上会回来，不用交接
+    if (poller && (woken > 0 || has_timers)) {
+      tickle();
+    }
+
     ELOG_DEBUG(g_logger) << "idle: epoll wait, res: " << res;
 
     // 处理epoll事件
     for (int i = 0; i < res; ++i) {
       epoll_event& event = ep_events[i];
 
-      // 处理管道唤醒事件
-      if (event.data.fd == m_tickleFds[0]) {
-        uint8_t dummy{};
-        // 如果是被tickle唤醒的，将所有的数据全都读取出来
-        while (read(event.data.fd, &dummy, 1) > 0)
-          ;
-        continue;
-      }
-
       // 处理文件描述符的IO事件
       FdContext* fd_ctx = static_cast<FdContext*>(event.data.ptr);
 
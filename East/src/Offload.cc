@@ -0,0 +1,170 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 22:15:41
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 22:15:41
+ */
+
+#include "Offload.h"
+#include <time.h>
+#include <algorithm>
+#include "Config.h"
+#include "Elog.h"
+#include "Macro.h"
+
+namespace East {
+
+static East::Logger::sptr g_logger = ELOG_NAME("system");
+
+static ConfigVar<uint32_t>::sptr g_offload_threads = Config::Lookup<uint32_t>(
+    "offload.threads", 4, "threads of the default offload pool");
+
+static ConfigVar<uint32_t>::sptr g_offload_max_queue =
+    Config::Lookup<uint32_t>("offload.max_queue", 1024,
+                             "max queued calls of the default offload pool");
+
+static uint64_t NowInNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void UpdateMax(std::atomic<uint64_t>& max, uint64_t v) {
+  uint64_t cur = max.load(std::memory_order_relaxed);
+  while (v > cur &&
+         !max.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {
+  }
+}
+
+OffloadPool::OffloadPool(const std::string& name, size_t threads,
+                         size_t max_queue)
+    : m_name(name), m_maxQueue(std::max<size_t>(max_queue, 1)) {
+  threads = std::max<size_t>(threads, 1);
+  for (size_t i = 0; i < threads; ++i) {
+    m_threads.push_back(std::make_shared<Thread>(
+        m_name + "_" + std::to_string(i), [this]() { threadMain(); }));
+  }
+}
+
+OffloadPool::~OffloadPool() {
+  {
+    Mutex::LockGuard lock(m_mutex);
+    m_stopping = true;
+  }
+  for (size_t i = 0; i < m_threads.size(); ++i) {
+    m_sem.notify();
+  }
+  for (auto& t : m_threads) {
+    t->join();
+  }
+}
+
+void OffloadPool::submit(Job* job) {
+  Semaphore sem;
+  bool waited = false;
+  m_mutex.lock();
+  EAST_ASSERT(!m_stopping);
+  while (m_queued >= m_maxQueue) {
+    if (!waited) {
+      waited = true;
+      m_fullWaits.fetch_add(1, std::memory_order_relaxed);
+    }
+    //每取走一个调用唤醒一个等待者，被唤醒时空位可能又被别人占了，重新检查
+    Fiber::WaitNode* node = FiberParker::Prepare(&sem);
+    m_spaceWaiters.push(node);
+    m_mutex.unlock();
+    FiberParker::Park(node, "offload_full");
+    m_mutex.lock();
+  }
+  job->node = FiberParker::Prepare(&sem);
+  job->enqueue_ns = NowInNs();
+  job->next = nullptr;
+  if (nullptr != m_tail) {
+    m_tail->next = job;
+  } else {
+    m_head = job;
+  }
+  m_tail = job;
+  size_t queued = ++m_queued;
+  m_mutex.unlock();
+
+  UpdateMax(m_maxQueued, queued);
+  m_submitted.fetch_add(1, std::memory_order_relaxed);
+  m_sem.notify();
+  FiberParker::Park(job->node, "offload");
+}
+
+void OffloadPool::threadMain() {
+  while (true) {
+    m_sem.wait();
+    Job* job = nullptr;
+    Fiber::WaitNode* waiter = nullptr;
+    {
+      Mutex::LockGuard lock(m_mutex);
+      if (nullptr == m_head) {
+        if (m_stopping) {
+          return;
+        }
+        continue;
+      }
+      job = m_head;
+      m_head = job->next;
+      if (nullptr == m_head) {
+        m_tail = nullptr;
+      }
+      --m_queued;
+      waiter = m_spaceWaiters.pop();
+    }
+    if (nullptr != waiter) {
+      FiberParker::Wake(waiter);
+    }
+
+    uint64_t begin_ns = NowInNs();
+    uint64_t wait_us = (begin_ns - job->enqueue_ns) / 1000;
+    m_waitUs.fetch_add(wait_us, std::memory_order_relaxed);
+    UpdateMax(m_maxWaitUs, wait_us);
+
+    m_running.fetch_add(1, std::memory_order_relaxed);
+    job->invoke();
+    m_running.fetch_sub(1, std::memory_order_relaxed);
+    m_runUs.fetch_add((NowInNs() - begin_ns) / 1000,
+                      std::memory_order_relaxed);
+    m_completed.fetch_add(1, std::memory_order_relaxed);
+
+    //唤醒之后调用方随时可能释放job，不能再访问
+    FiberParker::Wake(job->node);
+  }
+}
+
+OffloadPool::Stats OffloadPool::getStats() const {
+  Stats stats;
+  stats.threads = m_threads.size();
+  stats.max_queue = m_maxQueue;
+  {
+    Mutex::LockGuard lock(m_mutex);
+    stats.queued = m_queued;
+  }
+  stats.running = m_running.load(std::memory_order_relaxed);
+  stats.max_queued = m_maxQueued.load(std::memory_order_relaxed);
+  stats.submitted = m_submitted.load(std::memory_order_relaxed);
+  stats.completed = m_completed.load(std::memory_order_relaxed);
+  stats.full_waits = m_fullWaits.load(std::memory_order_relaxed);
+  stats.wait_us = m_waitUs.load(std::memory_order_relaxed);
+  stats.max_wait_us = m_maxWaitUs.load(std::memory_order_relaxed);
+  stats.run_us = m_runUs.load(std::memory_order_relaxed);
+  return stats;
+}
+
+OffloadPool* OffloadPool::GetDefault() {
+  static OffloadPool* s_pool = []() {
+    ELOG_INFO(g_logger) << "default offload pool, threads: "
+                        << g_offload_threads->getValue()
+                        << ", max_queue: " << g_offload_max_queue->getValue();
+    //不析构，进程退出时可能还有协程在等待
+    return new OffloadPool("offload", g_offload_threads->getValue(),
+                           g_offload_max_queue->getValue());
+  }();
+  return s_pool;
+}
+
+}  // namespace East
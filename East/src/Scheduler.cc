@@ -5,9 +5,16 @@
  * @Last Modified time: 2025-04-09 01:25:17
  */
 #include "Scheduler.h"
+#include <time.h>
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <unordered_map>
+#include "Config.h"
 #include "Elog.h"
 #include "Hook.h"
 #include "Macro.h"
+#include "util.h"
 
 namespace East {
 
@@ -16,6 +23,58 @@ namespace East {
  */
 static East::Logger::sptr g_logger = ELOG_NAME("system");
 
+static ConfigVar<bool>::sptr g_scheduler_edf = Config::Lookup<bool>(
+    "scheduler.edf", false, "earliest deadline first scheduling");
+
+static ConfigVar<uint32_t>::sptr g_scheduler_global_queue_capacity =
+    Config::Lookup<uint32_t>("scheduler.global_queue_capacity", 4096,
+                             "scheduler global lock-free queue capacity");
+
+static ConfigVar<uint32_t>::sptr g_scheduler_batch_size =
+    Config::Lookup<uint32_t>("scheduler.batch_size", 16,
+                             "max tasks taken from a shared queue at once");
+
+static ConfigVar<std::map<std::string, std::vector<uint32_t>>>::sptr
+    g_scheduler_elastic_threads =
+        Config::Lookup("scheduler.elastic_threads",
+                       std::map<std::string, std::vector<uint32_t>>{},
+                       "[min, max] worker threads by scheduler name");
+
+static ConfigVar<uint32_t>::sptr g_scheduler_elastic_interval =
+    Config::Lookup<uint32_t>("scheduler.elastic_interval_ms", 100,
+                             "interval(ms) between worker count adjustments");
+
+static ConfigVar<std::map<std::string, std::string>>::sptr
+    g_scheduler_affinity = Config::Lookup(
+        "scheduler.affinity", std::map<std::string, std::string>{},
+        "cpu list(0-3,8) or numa nodes(node:0,1) of worker threads by "
+        "scheduler name");
+
+static constexpr uint32_t kDefaultGroupWeight = 100;  ///< 默认组的权重
+
+static std::atomic<uint64_t> s_scheduler_id{0};  ///< 调度器id计数器
+
+/**
+ * @brief 存活的调度器，按id查找
+ *
+ * 协程只记录调度器id，导出协程时按id查名称，不会碰到已经析构的调度器
+ */
+struct SchedulerRegistry {
+  Mutex mutex;
+  std::unordered_map<uint64_t, Scheduler*> schedulers;
+};
+
+static SchedulerRegistry& GetSchedulerRegistry() {
+  static SchedulerRegistry* s_registry = new SchedulerRegistry;  //不析构，静态对象析构时可能还在用
+  return *s_registry;
+}
+
+static uint64_t NowInNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
 /**
  * @brief 线程本地存储：当前线程的调度器指针
  * 
@@ -39,6 +98,185 @@ static thread_local Fiber* t_scheduler_fiber = nullptr;
  */
 std::atomic<int32_t> Scheduler::s_task_id{0};
 
+/**
+ * @brief 每个线程的任务队列
+ *
+ * local由自己和偷任务的线程共享，用一个很少有竞争的自旋锁保护，自己从尾部取（后进先出，缓存友好），
+ * 其他线程从头部偷（先进先出）；inbox是无锁的多生产者单消费者栈，存放指定到这个线程的任务，
+ * 只有自己取，取出后按提交顺序放进pinned，EDF模式下带截止时间的按截止时间放进deadline，
+ * 其他线程永远不会扫描到这些任务。
+ */
+struct alignas(64) Scheduler::Worker {
+  struct Node {
+    ExecuteTask task;
+    Node* next{nullptr};
+  };
+
+  Scheduler* owner{nullptr};          ///< 所属调度器
+  size_t index{0};                    ///< 在m_workers中的下标
+  std::atomic<int> thread_id{-1};     ///< 绑定的线程id，线程启动后才知道
+  SpinLock lock;                      ///< 保护local
+  std::deque<ExecuteTask> local;      ///< 本地队列
+  std::atomic<size_t> local_size{0};  ///< local的大小，偷之前不加锁先看一眼
+  std::atomic<Node*> inbox{nullptr};  ///< 指定到这个线程的任务
+  std::deque<ExecuteTask> pinned;     ///< 从inbox取出的任务，只有自己访问
+  std::deque<ExecuteTask> deadline;   ///< 指定到这个线程、带截止时间的任务，按截止时间排序，只有自己访问
+  uint32_t tick{0};                   ///< 取任务的次数，定期先看全局队列
+  std::atomic<bool> parked{false};    ///< 是否阻塞在idle中等待唤醒
+  std::atomic<bool> tickled{false};   ///< 是否是被tickle选中唤醒的
+  bool count_wakeup{false};           ///< 被tickle唤醒后下一次取任务计入统计
+  bool refilled{false};               ///< 上一次取任务时批量搬进了本地队列
+  std::atomic<bool> retiring{false};  ///< 线程被选中退出，之后提交给它的任务要转交出去
+  std::atomic<bool> exited{false};    ///< 线程已经退出，队列可以给新线程复用
+  Thread::sptr thread;                ///< 绑定的线程，调用者线程为空
+  std::vector<ExecuteTask> batch;     ///< 批量取任务的临时缓冲，只有自己访问
+
+  ~Worker() {
+    Node* n = inbox.exchange(nullptr);
+    while (nullptr != n) {
+      Node* next = n->next;
+      delete n;
+      n = next;
+    }
+  }
+
+  /**
+   * @brief 在绑定好CPU的线程里重新分配队列的内存，首次访问的页落在线程所在的NUMA节点上
+   */
+  void rehome(size_t batch_size) {
+    {
+      SpinLock::LockGuard guard(lock);
+      std::deque<ExecuteTask> tmp(std::make_move_iterator(local.begin()),
+                                  std::make_move_iterator(local.end()));
+      local.swap(tmp);
+    }
+    std::deque<ExecuteTask> tmp(std::make_move_iterator(pinned.begin()),
+                                std::make_move_iterator(pinned.end()));
+    pinned.swap(tmp);
+    std::deque<ExecuteTask> tmp2(std::make_move_iterator(deadline.begin()),
+                                 std::make_move_iterator(deadline.end()));
+    deadline.swap(tmp2);
+    std::vector<ExecuteTask> buf;
+    buf.reserve(batch_size);
+    batch.swap(buf);
+  }
+
+  /**
+   * @return 收件箱之前是否为空
+   */
+  bool pushInbox(ExecuteTask&& task) {
+    Node* n = new Node{std::move(task), nullptr};
+    n->next = inbox.load(std::memory_order_relaxed);
+    //和parked构成Dekker式的同步：先入队再看parked，对端先置parked再看inbox
+    while (!inbox.compare_exchange_weak(n->next, n)) {
+    }
+    return nullptr == n->next;
+  }
+
+  void drainInbox() {
+    if (nullptr == inbox.load(std::memory_order_relaxed)) {
+      return;
+    }
+    Node* n = inbox.exchange(nullptr, std::memory_order_acquire);
+    //栈是后进先出的，反转之后按提交顺序放进pinned
+    Node* head = nullptr;
+    while (nullptr != n) {
+      Node* next = n->next;
+      n->next = head;
+      head = n;
+      n = next;
+    }
+    while (nullptr != head) {
+      Node* next = head->next;
+      pushPinned(std::move(head->task));
+      delete head;
+      head = next;
+    }
+  }
+
+  /**
+   * @brief 放进指定到自己的队列，EDF模式下带截止时间的任务按截止时间插入deadline
+   */
+  void pushPinned(ExecuteTask&& task) {
+    if (0 == task.deadline || !owner->m_edf) {
+      pinned.push_back(std::move(task));
+      return;
+    }
+    auto it = deadline.end();
+    while (it != deadline.begin() && std::prev(it)->deadline > task.deadline) {
+      --it;
+    }
+    deadline.insert(it, std::move(task));
+  }
+
+  /**
+   * @brief 把batch中的任务放进本地队列，加一次锁
+   *
+   * 自己从尾部取，所以倒序放进去，batch中先取出的任务先执行。
+   */
+  void pushBatch() {
+    if (batch.empty()) {
+      return;
+    }
+    {
+      SpinLock::LockGuard lock(this->lock);
+      for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+        local.push_back(std::move(*it));
+      }
+      local_size += batch.size();
+    }
+    batch.clear();
+    refilled = true;
+  }
+
+  /**
+   * @brief 从q中取一个可以执行的任务，跳过还没切出去的协程（唤醒可能早于挂起）
+   * @param from_back 从尾部开始找
+   */
+  static bool Take(std::deque<ExecuteTask>& q, ExecuteTask& task,
+                   bool from_back) {
+    size_t n = q.size();
+    for (size_t i = 0; i < n; ++i) {
+      size_t pos = from_back ? n - 1 - i : i;
+      ExecuteTask& t = q[pos];
+      if (t.fiber && t.fiber->getState() == Fiber::EXEC) {
+        continue;
+      }
+      task = std::move(t);
+      q.erase(q.begin() + pos);
+      return true;
+    }
+    return false;
+  }
+};
+
+/**
+ * @brief 任务组
+ *
+ * 默认组的任务走线程的本地队列和全局队列，这里只记账；其他组的任务排在自己的队列里，
+ * 用一个很少有竞争的自旋锁保护。
+ * vtime是组的虚拟时间，执行这个组的任务时加上 执行时间*默认权重/权重，默认组的虚拟时间就是实际执行时间。
+ */
+struct alignas(64) Scheduler::Group {
+  std::string name;                        ///< 名称
+  std::atomic<uint32_t> weight{kDefaultGroupWeight};  ///< 权重
+  bool priority{false};                    ///< 是否是优先通道
+  SpinLock lock;                           ///< 保护tasks
+  std::deque<ExecuteTask> tasks;           ///< 排队的任务，默认组不用
+  std::atomic<size_t> depth{0};            ///< tasks的大小，取之前不加锁先看一眼
+  std::atomic<uint64_t> vtime{0};          ///< 虚拟时间
+  std::atomic<uint64_t> scheduled{0};      ///< 调度的次数
+  std::atomic<uint64_t> executed{0};       ///< 取出执行的次数
+  std::atomic<uint64_t> wait_ns{0};        ///< 总等待时间
+  std::atomic<uint64_t> max_wait_ns{0};    ///< 最长等待时间
+  std::atomic<uint64_t> run_ns{0};         ///< 总执行时间
+};
+
+/**
+ * @brief 线程本地存储：当前线程的任务队列
+ */
+thread_local Scheduler::Worker* Scheduler::t_worker = nullptr;
+
 /**
  * @brief 构造函数实现
  * 
@@ -53,8 +291,17 @@ std::atomic<int32_t> Scheduler::s_task_id{0};
  * @param name 调度器名称
  */
 Scheduler::Scheduler(size_t threads, bool use_caller, const std::string& name)
-    : m_name(name) {
+    : m_injectQueue(g_scheduler_global_queue_capacity->getValue()),
+      m_name(name),
+      m_id(++s_scheduler_id) {
   EAST_ASSERT2(threads > 0, "threads must be at least 1");
+  {
+    SchedulerRegistry& r = GetSchedulerRegistry();
+    Mutex::LockGuard lock(r.mutex);
+    r.schedulers[m_id] = this;
+  }
+  m_batchSize = std::max<size_t>(1, g_scheduler_batch_size->getValue());
+  m_edf = g_scheduler_edf->getValue();
 
   //user_caller: 是否使用当前调用线程
   if (use_caller) {
@@ -77,6 +324,41 @@ Scheduler::Scheduler(size_t threads, bool use_caller, const std::string& name)
     m_rootThreadId = -1;
   }
   m_threadCount = threads;
+  m_defaultThreads = threads;
+
+  //调用者线程的队列在前面，线程池的队列在start时绑定线程
+  size_t worker_count = m_threadCount + (use_caller ? 1 : 0);
+  EAST_ASSERT2(worker_count <= kMaxThreads, "too many threads");
+  m_workers.resize(kMaxThreads, nullptr);
+  for (size_t i = 0; i < worker_count; ++i) {
+    Worker* w = new Worker;
+    w->owner = this;
+    w->index = i;
+    w->batch.reserve(m_batchSize);
+    m_workers[i] = w;
+  }
+  m_workerSlots = worker_count;
+  if (use_caller) {
+    m_workers[0]->thread_id = m_rootThreadId;
+  }
+
+  applyThreadRange(g_scheduler_elastic_threads->getValue());
+  m_rangeListener = g_scheduler_elastic_threads->addListener(
+      [this](const std::map<std::string, std::vector<uint32_t>>&,
+             const std::map<std::string, std::vector<uint32_t>>& ranges) {
+        applyThreadRange(ranges);
+      });
+
+  applyAffinity(g_scheduler_affinity->getValue());
+  m_affinityListener = g_scheduler_affinity->addListener(
+      [this](const std::map<std::string, std::string>&,
+             const std::map<std::string, std::string>& specs) {
+        applyAffinity(specs);
+      });
+
+  m_groups.resize(kMaxGroups, nullptr);
+  m_groups[kDefaultGroup] = new Group;
+  m_groups[kDefaultGroup]->name = "default";
 }
 
 /**
@@ -87,9 +369,36 @@ Scheduler::Scheduler(size_t threads, bool use_caller, const std::string& name)
  */
 Scheduler::~Scheduler() {
   EAST_ASSERT(m_stopping);
+  {
+    SchedulerRegistry& r = GetSchedulerRegistry();
+    Mutex::LockGuard lock(r.mutex);
+    r.schedulers.erase(m_id);
+  }
+  g_scheduler_elastic_threads->delListener(m_rangeListener);
+  g_scheduler_affinity->delListener(m_affinityListener);
   if (GetThis() == this) {
     t_scheduler = nullptr;
   }
+  if (nullptr != t_worker && t_worker->owner == this) {
+    t_worker = nullptr;
+  }
+  for (auto w : m_workers) {
+    delete w;
+  }
+  for (auto g : m_groups) {
+    delete g;
+  }
+}
+
+bool Scheduler::GetNameById(uint64_t id, std::string& name) {
+  SchedulerRegistry& r = GetSchedulerRegistry();
+  Mutex::LockGuard lock(r.mutex);
+  auto it = r.schedulers.find(id);
+  if (it == r.schedulers.end()) {
+    return false;
+  }
+  name = it->second->getName();
+  return true;
 }
 
 /**
@@ -134,15 +443,33 @@ void Scheduler::start() {
     return;
   m_stopping = false;
   EAST_ASSERT2(m_threads.empty(), "m_threads is not empty");
-  m_threads.resize(m_threadCount);
 
+  size_t offset = m_workerSlots - m_threadCount;
   for (size_t i = 0; i < m_threadCount; ++i) {
-    m_threads[i].reset(new Thread(m_name + "_" + std::to_string(i),
-                                  std::bind(&Scheduler::run, this)));
-    m_threadIds.emplace_back(m_threads[i]->getId());
+    startThread(m_workers[offset + i]);
   }
 }
 
+void Scheduler::startThread(Worker* w) {
+  size_t offset = -1 != m_rootThreadId ? 1 : 0;
+  std::vector<int> cpus = workerCpus(w->index - offset);
+  bool pinned = !cpus.empty();
+  w->thread.reset(new Thread(
+      m_name + "_" + std::to_string(w->index - offset),
+      [this, w, pinned]() {
+        w->thread_id = East::GetThreadId();
+        t_worker = w;
+        if (pinned) {
+          w->rehome(m_batchSize);
+        }
+        run();
+        w->exited = true;  //最后一步，之后join不会等待
+      },
+      cpus));
+  m_threads.push_back(w->thread);
+  m_threadIds.emplace_back(w->thread->getId());
+}
+
 /**
  * @brief 停止调度器
  * 
@@ -223,6 +550,7 @@ void Scheduler::stop() {
  * 3. **任务执行**：
  *    - 协程任务：检查状态并执行，处理完成后根据状态决定是否重新调度
  *    - 函数任务：使用专用协程执行，支持重用协程对象
+ *    - 执行完的协程放回线程私有的空闲链表，新的函数任务优先从中取协程
  *    - 空闲处理：当没有任务时执行空闲协程
  * 
  * 4. **状态管理**：
@@ -250,56 +578,81 @@ void Scheduler::run() {
   //创建一个idle协程，专门用于处理空闲状态
   Fiber::sptr idle_fiber =
       std::make_shared<Fiber>(std::bind(&Scheduler::idle, this));
-  Fiber::sptr cb_fiber{nullptr};  //用于执行回调函数
+  Fiber::sptr private_cb_fiber{nullptr};  //用于执行回调函数
+  Fiber::sptr shared_cb_fiber{nullptr};   //用于在共享栈上执行回调函数
+
+  Worker* worker = currentWorker();
+  if (nullptr == worker) {
+    worker = findWorker(East::GetThreadId());  //调用者线程
+    t_worker = worker;
+  }
+  EAST_ASSERT2(nullptr != worker, "no worker for this thread");
 
   ExecuteTask task{};
   while (true) {
     task.reset();
 
+    //按负载增减线程，选中退出的是自己时先让idle协程结束，再把队列里的任务交出去
+    if (adjustThreads(worker)) {
+      if (idle_fiber->getState() != Fiber::TERM) {
+        idle_fiber->resume();
+      }
+      retire(worker);
+      break;
+    }
+
     bool tickle_me = false;
     bool is_active = false;
-    {
-      MutexType::LockGuard lock(m_mutex);
-      auto it = m_tasks.begin();
-      while (it != m_tasks.end()) {
-        //如果是指定线程执行，且不是当前线程，就跳过
-        if (it->thread_id != -1 && it->thread_id != East::GetThreadId()) {
-          ++it;
-          tickle_me = true;
-          continue;
-        }
-
-        EAST_ASSERT(it->fiber || it->cb);
-        //如果是协程且协程已经在执行，也直接跳过
-        if (it->fiber && it->fiber->getState() == Fiber::EXEC) {
-          ++it;
-          continue;
-        }
-
-        task = *it;
-        it = m_tasks.erase(it);
-        ++m_activeThreadCount;
-        is_active = true;
-        break;
-      }
-      tickle_me = tickle_me || it != m_tasks.end();
+    //先计入活跃线程再取任务，stopping不会看到任务已经出队但还没有线程在执行的状态
+    ++m_activeThreadCount;
+    if (takeTask(worker, task)) {
+      --m_pendingTasks;
+      is_active = true;
+    } else {
+      --m_activeThreadCount;
     }
+    if (worker->count_wakeup) {
+      worker->count_wakeup = false;
+      ++(is_active ? m_wakeUseful : m_wakeWasted);
+    }
+    //还有别的线程可以取的任务才唤醒其他线程，指定给别的线程的任务在提交时已经定向唤醒了目标线程。
+    //本地队列里的任务只在批量搬进来时唤醒一次，之后连续执行不再检查；
+    //自己提交的任务在队列由空变为非空时已经唤醒过，空闲线程阻塞之前也会看到它们
+    tickle_me = worker->refilled || !m_injectQueue.empty() ||
+                0 != m_globalTasks || 0 != m_groupTasks;
     if (tickle_me) {
       tickle();
     }
     if (task.isValidTask()) {
       ELOG_DEBUG(g_logger) << "Hanlded task in queue, id: " << task.getTaskId()
                            << ", task type: " << task.getTaskType()
-                           << ", task queue size: " << m_tasks.size();
+                           << ", pending tasks: " << m_pendingTasks;
       if (task.getTaskType() == ExecuteTask::FIBER) {
         ELOG_DEBUG(g_logger) << "fiber state: " << task.fiber->getState();
       }
+      if (0 != task.deadline && handleExpired(task)) {
+        --m_activeThreadCount;
+        task.reset();
+        continue;
+      }
+    }
+
+    //添加过任务组之后，记录任务的等待时间，执行完按执行时间累计所属组的虚拟时间
+    Group* group = nullptr;
+    uint64_t begin_ns = 0;
+    if (task.isValidTask() && m_groupCount > 1) {
+      group = beginGroupTask(task);
+      begin_ns = NowInNs();
     }
 
     //如果协程的状态可以执行，则执行                          //TODO: 这里的状态判断有点问题, 如果是hold状态，现在不一定能执行，因为可能有定时器
     if (task.getTaskType() == ExecuteTask::FIBER &&
         (task.fiber->getState() != Fiber::TERM &&
          task.fiber->getState() != Fiber::EXCEPT)) {
+      if (0 != task.deadline) {
+        task.fiber->setDeadline(task.deadline);
+      }
+      task.fiber->setGroup(task.group < 0 ? kDefaultGroup : task.group);
       task.fiber->resume();
       --m_activeThreadCount;
 
@@ -308,27 +661,35 @@ void Scheduler::run() {
         ELOG_DEBUG(g_logger) << "After resume, task fiber is on ready state, "
                                 "put back to queue. Task id: "
                              << task.getTaskId();
-        schedule(task.fiber);
+        requeue(task.fiber);
       } else if (task.fiber->getState() != Fiber::TERM &&
                  task.fiber->getState() != Fiber::EXCEPT) {
         task.fiber->setState(Fiber::HOLD);
       }
+      if (task.fiber->getState() == Fiber::TERM) {
+        Fiber::Recycle(task.fiber);  //执行完的协程放回空闲链表，下次直接复用
+      }
       task.reset();
     } else if (task.getTaskType() == ExecuteTask::FUNCTION) {
+      Fiber::sptr& cb_fiber =
+          task.shared_stack ? shared_cb_fiber : private_cb_fiber;
       if (cb_fiber != nullptr) {
-        cb_fiber->reset(task.cb);
+        cb_fiber->reset(std::move(task.cb));
       } else {
-        cb_fiber = std::make_shared<Fiber>(task.cb);
+        cb_fiber = Fiber::Create(std::move(task.cb), 0, true, task.shared_stack);
       }
+      cb_fiber->setDeadline(task.deadline);  //派生出去的任务继承这个截止时间
+      cb_fiber->setGroup(task.group < 0 ? kDefaultGroup : task.group);
       task.reset();
       cb_fiber->resume();
       --m_activeThreadCount;
       if (cb_fiber->getState() == Fiber::READY) {
-        schedule(cb_fiber);
+        requeue(cb_fiber);
         cb_fiber.reset();
-      } else if (cb_fiber->getState() == Fiber::EXCEPT ||
-                 cb_fiber->getState() == Fiber::TERM) {
+      } else if (cb_fiber->getState() == Fiber::TERM) {
         cb_fiber->reset(nullptr);
+      } else if (cb_fiber->getState() == Fiber::EXCEPT) {
+        cb_fiber.reset();  //异常退出的协程不能reset，直接丢弃
       } else {
         cb_fiber->setState(
             Fiber::
@@ -354,9 +715,828 @@ void Scheduler::run() {
         idle_fiber->setState(Fiber::HOLD);  //TODO
       }
     }
+    if (nullptr != group) {
+      chargeGroup(group, NowInNs() - begin_ns);
+    }
   }
 }
 
+/**
+ * @brief 从全局队列或EDF队列中取出当前线程可以执行的第一个任务
+ *
+ * 跳过指定了其他线程的任务（指定的线程还没启动时才会放进全局队列）和已经在执行的协程。
+ */
+bool Scheduler::takeTaskNoLock(std::list<ExecuteTask>& tasks,
+                               ExecuteTask& task) {
+  for (auto it = tasks.begin(); it != tasks.end(); ++it) {
+    //如果是指定线程执行，且不是当前线程，就跳过
+    if (it->thread_id != -1 && it->thread_id != East::GetThreadId()) {
+      continue;
+    }
+
+    EAST_ASSERT(it->fiber || it->cb);
+    //如果是协程且协程已经在执行，也直接跳过
+    if (it->fiber && it->fiber->getState() == Fiber::EXEC) {
+      continue;
+    }
+
+    task = std::move(*it);
+    tasks.erase(it);
+    --m_globalTasks;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief 从全局队列中取任务
+ *
+ * 先取无锁队列，再取溢出的链表：队列满之后新任务都进链表，直到链表里的任务被取完，
+ * 所以两部分合起来基本还是先进先出。
+ * 无锁队列每次取一个；溢出链表加一次锁最多取m_batchSize个，除了返回的第一个，
+ * 其余的放进本地队列，连续执行时不用再碰全局的锁，多出来的任务其他空闲线程可以偷走。
+ */
+bool Scheduler::takeGlobal(Worker* worker, ExecuteTask& task) {
+  //无锁队列里都是没有指定线程的任务，取到还在执行的协程（唤醒比切出早）就放回队尾
+  for (size_t n = m_injectQueue.size(); n > 0 && m_injectQueue.pop(task);
+       --n) {
+    if (!task.fiber || task.fiber->getState() != Fiber::EXEC) {
+      return true;
+    }
+    pushGlobal(std::move(task));
+  }
+
+  if (0 == m_globalTasks) {
+    return false;
+  }
+  {
+    MutexType::LockGuard lock(m_mutex);
+    if (!takeTaskNoLock(m_tasks, task)) {
+      return false;
+    }
+    if (-1 == task.thread_id) {
+      --m_overflowTasks;
+    }
+    ExecuteTask t;
+    for (size_t i = 1; i < m_batchSize && takeTaskNoLock(m_tasks, t); ++i) {
+      if (-1 == t.thread_id) {
+        --m_overflowTasks;
+        worker->batch.push_back(std::move(t));
+      } else {
+        worker->pushPinned(std::move(t));  //指定到自己的任务不能被偷
+      }
+    }
+  }
+  worker->pushBatch();
+  return true;
+}
+
+bool Scheduler::pushGlobal(ExecuteTask&& task) {
+  if (-1 == task.thread_id && 0 == m_overflowTasks) {
+    bool was_empty = m_injectQueue.empty();
+    if (m_injectQueue.push(std::move(task))) {
+      return was_empty;
+    }
+  }
+  //队列满或者指定的线程还没有启动，走加锁的慢路径
+  MutexType::LockGuard lock(m_mutex);
+  if (-1 == task.thread_id) {
+    ++m_overflowTasks;
+  }
+  m_tasks.push_back(std::move(task));
+  return 0 == m_globalTasks++;
+}
+
+bool Scheduler::takeTask(Worker* worker, ExecuteTask& task) {
+  worker->refilled = false;
+  worker->drainInbox();
+  //EDF队列里的任务优先，全局的和指定到自己的谁的截止时间早先取谁
+  if (m_edf && m_globalTasks > 0) {
+    MutexType::LockGuard lock(m_mutex);
+    if ((worker->deadline.empty() || m_deadlineTasks.empty() ||
+         m_deadlineTasks.front().deadline < worker->deadline.front().deadline) &&
+        takeTaskNoLock(m_deadlineTasks, task)) {
+      return true;
+    }
+  }
+  if (Worker::Take(worker->deadline, task, false)) {
+    return true;
+  }
+  if (Worker::Take(worker->pinned, task, false)) {
+    return true;
+  }
+
+  //其他组有任务排队时先按加权公平选组，轮到默认组才走下面的队列
+  if (0 != m_groupTasks) {
+    Group* group = pickGroup(true);
+    if (group != m_groups[kDefaultGroup] && takeGroup(group, task)) {
+      return true;
+    }
+  }
+
+  //本地队列一直不空时全局队列会饿死，隔一段时间先看一次全局队列
+  if (0 == ++worker->tick % 61 && takeGlobal(worker, task)) {
+    return true;
+  }
+
+  if (worker->local_size > 0) {
+    SpinLock::LockGuard lock(worker->lock);
+    if (Worker::Take(worker->local, task, true)) {
+      --worker->local_size;
+      return true;
+    }
+  }
+
+  if (takeGlobal(worker, task)) {
+    return true;
+  }
+
+  //从下一个线程开始，依次从其他线程的本地队列头部偷，一次偷走一半，最多m_batchSize个
+  size_t n = m_workerSlots;
+  for (size_t i = 1; i < n; ++i) {
+    Worker* victim = m_workers[(worker->index + i) % n];
+    if (0 == victim->local_size) {
+      continue;
+    }
+    {
+      SpinLock::LockGuard lock(victim->lock);
+      if (!Worker::Take(victim->local, task, false)) {
+        continue;
+      }
+      size_t extra = std::min(victim->local.size() / 2, m_batchSize - 1);
+      ExecuteTask t;
+      while (extra-- > 0 && Worker::Take(victim->local, t, false)) {
+        worker->batch.push_back(std::move(t));
+      }
+      victim->local_size -= 1 + worker->batch.size();
+    }
+    //先放开对方的锁再加自己的锁，两个线程互相偷时不会死锁
+    worker->pushBatch();
+    return true;
+  }
+  return 0 != m_groupTasks && takeAnyGroup(task);
+}
+
+bool Scheduler::submit(ExecuteTask&& task, uint64_t deadline) {
+  if (0 == deadline) {
+    deadline = task.fiber ? task.fiber->getDeadline() : Fiber::CurrentDeadline();
+  }
+  task.deadline = deadline;
+  if (task.group < 0) {
+    task.group = task.fiber ? task.fiber->getGroup() : Fiber::CurrentGroup();
+    if (task.group >= m_groupCount) {
+      task.group = kDefaultGroup;  //从其他调度器带过来的任务组
+    }
+  }
+  EAST_ASSERT2(task.group < m_groupCount, "invalid task group");
+  if (m_groupCount > 1) {
+    task.enqueue_ns = NowInNs();
+    ++m_groups[task.group]->scheduled;
+  }
+  int task_id = task.getTaskId();
+  int thread_id = task.thread_id;
+
+  //先计数再入队，stopping不会在任务入队的过程中看到0
+  ++m_pendingTasks;
+  bool need_tickle = false;
+  Worker* cur = currentWorker();
+  Worker* target = -1 != thread_id ? findWorker(thread_id) : nullptr;
+  if (m_edf && 0 != deadline) {
+    ++m_deadlineScheduled;
+  }
+  if (m_edf && 0 != deadline && -1 == thread_id) {
+    MutexType::LockGuard lock(m_mutex);
+    insertByDeadlineNoLock(std::move(task));
+    need_tickle = 0 == m_globalTasks++;
+  } else if (nullptr != target && target == cur) {
+    cur->pushPinned(std::move(task));
+  } else if (nullptr != target) {
+    //只有目标线程能执行，唤醒任意线程没有意义
+    target->pushInbox(std::move(task));
+    //先入队再看标记，退出的线程先置标记再取收件箱，总有一方会把任务交出去
+    if (target->retiring) {
+      handOffInbox(target);
+    } else {
+      wakeWorker(target);
+    }
+  } else if (kDefaultGroup != task.group && -1 == thread_id) {
+    Group* group = m_groups[task.group];
+    SpinLock::LockGuard lock(group->lock);
+    if (group->tasks.empty()) {
+      //空闲过的组不能攒下额度，从当前其他组中最小的虚拟时间开始
+      Group* min = pickGroup(true);
+      uint64_t vtime = nullptr == min || min->priority ? 0 : min->vtime.load();
+      if (group->vtime < vtime) {
+        group->vtime = vtime;
+      }
+    }
+    group->tasks.push_back(std::move(task));
+    ++group->depth;
+    need_tickle = 0 == m_groupTasks++;
+  } else if (nullptr != cur && -1 == thread_id) {
+    SpinLock::LockGuard lock(cur->lock);
+    cur->local.push_back(std::move(task));
+    need_tickle = 0 == cur->local_size++;
+  } else {
+    need_tickle = pushGlobal(std::move(task));
+  }
+  ELOG_DEBUG(g_logger) << "Add new task, task id: " << task_id
+                       << ", thread id: " << thread_id
+                       << ", deadline: " << deadline;
+  return need_tickle;
+}
+
+void Scheduler::requeue(Fiber::sptr fiber) {
+  ExecuteTask task(&fiber, -1);
+  task.deadline = task.fiber->getDeadline();
+  task.group = task.fiber->getGroup();
+  Worker* cur = currentWorker();
+  if (nullptr == cur || -1 != task.thread_id || (m_edf && 0 != task.deadline) ||
+      kDefaultGroup != task.group) {
+    uint64_t deadline = task.deadline;
+    if (submit(std::move(task), deadline)) {
+      tickle();
+    }
+    return;
+  }
+  if (m_groupCount > 1) {
+    task.enqueue_ns = NowInNs();
+    ++m_groups[kDefaultGroup]->scheduled;
+  }
+  ++m_pendingTasks;
+  SpinLock::LockGuard lock(cur->lock);
+  cur->local.push_front(std::move(task));
+  ++cur->local_size;
+}
+
+void Scheduler::wakeWorker(Worker* worker) {
+  //抢到parked的线程负责唤醒，目标线程被唤醒之前其他提交者不再重复唤醒
+  if (worker->parked.load() && worker->parked.exchange(false)) {
+    tickleThread(worker->index);
+  }
+}
+
+bool Scheduler::setParked(bool parked) {
+  Worker* worker = currentWorker();
+  if (nullptr == worker) {
+    return false;
+  }
+  if (parked) {
+    worker->parked = true;
+    {
+      SpinLock::LockGuard lock(m_parkedLock);
+      m_parkedWorkers.push_back(worker);
+    }
+    if (!hasReadyTask()) {
+      return true;
+    }
+    //进入阻塞列表之前提交的任务，提交者没有看到我们，不能阻塞
+  }
+  worker->parked = false;
+  {
+    SpinLock::LockGuard lock(m_parkedLock);
+    auto it = std::find(m_parkedWorkers.begin(), m_parkedWorkers.end(), worker);
+    if (it != m_parkedWorkers.end()) {
+      m_parkedWorkers.erase(it);
+    }
+  }
+  if (worker->tickled.exchange(false)) {
+    m_wakePending = false;  //被选中的线程醒了，之后的tickle可以唤醒下一个
+    worker->count_wakeup = true;
+  }
+  return false;
+}
+
+bool Scheduler::wakeParkedWorker() {
+  if (!m_stopping && m_wakePending.exchange(true)) {
+    ++m_wakeMerged;
+    return true;
+  }
+  while (true) {
+    Worker* worker = nullptr;
+    {
+      SpinLock::LockGuard lock(m_parkedLock);
+      if (m_parkedWorkers.empty()) {
+        break;
+      }
+      worker = m_parkedWorkers.back();
+      m_parkedWorkers.pop_back();
+    }
+    //先标记再抢parked，抢到之后它醒来时一定能看到标记并清掉m_wakePending
+    worker->tickled = true;
+    if (worker->parked.exchange(false)) {
+      ++m_wakeIssued;
+      tickleThread(worker->index);
+      return true;
+    }
+    worker->tickled = false;  //已经被别人唤醒，列表里是过时的记录
+  }
+  m_wakePending = false;
+  return false;
+}
+
+bool Scheduler::hasReadyTask() const {
+  Worker* worker = currentWorker();
+  if (nullptr != worker &&
+      (nullptr != worker->inbox.load() || !worker->pinned.empty() ||
+       !worker->deadline.empty())) {
+    return true;
+  }
+  if (!m_injectQueue.empty() || 0 != m_globalTasks || 0 != m_groupTasks) {
+    return true;
+  }
+  size_t n = m_workerSlots;
+  for (size_t i = 0; i < n; ++i) {
+    if (m_workers[i]->local_size > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int Scheduler::getWorkerIndex() const {
+  Worker* worker = currentWorker();
+  return nullptr != worker ? (int)worker->index : -1;
+}
+
+Scheduler::Worker* Scheduler::currentWorker() const {
+  return (nullptr != t_worker && t_worker->owner == this) ? t_worker : nullptr;
+}
+
+Scheduler::Worker* Scheduler::findWorker(int thread_id) const {
+  size_t n = m_workerSlots;
+  for (size_t i = 0; i < n; ++i) {
+    if (m_workers[i]->thread_id == thread_id) {
+      return m_workers[i];
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief 按截止时间插入EDF队列
+ *
+ * 新任务的截止时间大多比队列里的晚，从队尾往前找插入位置。
+ */
+void Scheduler::insertByDeadlineNoLock(ExecuteTask&& task) {
+  auto it = m_deadlineTasks.end();
+  while (it != m_deadlineTasks.begin()) {
+    auto prev = std::prev(it);
+    if (prev->deadline <= task.deadline) {
+      break;
+    }
+    it = prev;
+  }
+  m_deadlineTasks.insert(it, std::move(task));
+}
+
+/**
+ * @brief 处理已经过期、还没开始执行的任务
+ *
+ * 只在EDF模式下生效，已经开始执行的协程不管是否过期都要继续执行完。
+ */
+bool Scheduler::handleExpired(ExecuteTask& task) {
+  if (!m_edf || !task.notStarted() ||
+      East::GetCurrentTimeInMs() <= task.deadline) {
+    return false;
+  }
+  ++m_deadlineExpired;
+  int policy = m_expiredPolicy.load(std::memory_order_relaxed);
+  if (EXPIRED_RUN == policy) {
+    return false;
+  }
+  ++m_deadlineDropped;
+  ELOG_DEBUG(g_logger) << "Task expired before run, id: " << task.getTaskId()
+                       << ", deadline: " << task.deadline;
+  if (EXPIRED_CALLBACK == policy && m_expiredCallback) {
+    m_expiredCallback(std::move(task.fiber), std::move(task.cb), task.deadline);
+  }
+  return true;
+}
+
+void Scheduler::setEdf(bool v) {
+  MutexType::LockGuard lock(m_mutex);
+  m_edf = v;
+  if (!v && !m_deadlineTasks.empty()) {
+    for (auto& task : m_deadlineTasks) {
+      if (-1 == task.thread_id) {
+        ++m_overflowTasks;
+      }
+    }
+    m_tasks.splice(m_tasks.begin(), m_deadlineTasks);
+  }
+}
+
+void Scheduler::setExpiredPolicy(ExpiredPolicy policy, ExpiredCallback cb) {
+  m_expiredCallback = std::move(cb);
+  m_expiredPolicy = policy;
+}
+
+Scheduler::WakeupStats Scheduler::getWakeupStats() const {
+  WakeupStats stats;
+  stats.issued = m_wakeIssued;
+  stats.merged = m_wakeMerged;
+  stats.useful = m_wakeUseful;
+  stats.wasted = m_wakeWasted;
+  return stats;
+}
+
+int Scheduler::addGroup(const std::string& name, uint32_t weight,
+                        bool priority) {
+  EAST_ASSERT2(weight > 0, "group weight must be positive");
+  MutexType::LockGuard lock(m_mutex);
+  int id = m_groupCount;
+  EAST_ASSERT2(id < kMaxGroups, "too many task groups");
+  Group* group = new Group;
+  group->name = name;
+  group->weight = weight;
+  group->priority = priority;
+  //新组从默认组的虚拟时间开始，不会一加进来就独占工作线程
+  group->vtime = m_groups[kDefaultGroup]->vtime.load();
+  m_groups[id] = group;
+  m_groupCount = id + 1;  //先放好再计数，取任务的线程看到计数时一定能看到组
+  return id;
+}
+
+void Scheduler::setGroupWeight(int group, uint32_t weight) {
+  EAST_ASSERT2(group >= 0 && group < m_groupCount, "invalid task group");
+  EAST_ASSERT2(weight > 0, "group weight must be positive");
+  m_groups[group]->weight = weight;
+}
+
+std::vector<Scheduler::GroupStats> Scheduler::getGroupStats() const {
+  std::vector<GroupStats> result;
+  int count = m_groupCount;
+  size_t pending = m_pendingTasks;
+  size_t grouped = m_groupTasks;
+  for (int i = 0; i < count; ++i) {
+    Group* group = m_groups[i];
+    GroupStats stats;
+    stats.name = group->name;
+    stats.weight = group->weight;
+    stats.priority = group->priority;
+    //默认组的任务分散在各个队列里，用总数减去其他组的
+    stats.depth = kDefaultGroup == i ? (pending > grouped ? pending - grouped : 0)
+                                     : group->depth.load();
+    stats.scheduled = group->scheduled;
+    stats.executed = group->executed;
+    stats.wait_us = group->wait_ns / 1000;
+    stats.max_wait_us = group->max_wait_ns / 1000;
+    stats.run_us = group->run_ns / 1000;
+    result.push_back(std::move(stats));
+  }
+  return result;
+}
+
+Scheduler::Group* Scheduler::pickGroup(bool include_default) const {
+  Group* best = include_default ? m_groups[kDefaultGroup] : nullptr;
+  uint64_t best_vtime = include_default ? best->vtime.load() : 0;
+  int count = m_groupCount;
+  for (int i = 1; i < count; ++i) {
+    Group* group = m_groups[i];
+    if (0 == group->depth) {
+      continue;
+    }
+    if (group->priority) {
+      return group;
+    }
+    uint64_t vtime = group->vtime;
+    if (nullptr == best || vtime < best_vtime) {
+      best = group;
+      best_vtime = vtime;
+    }
+  }
+  return best;
+}
+
+bool Scheduler::takeGroup(Group* group, ExecuteTask& task) {
+  if (0 == group->depth) {
+    return false;
+  }
+  SpinLock::LockGuard lock(group->lock);
+  if (!Worker::Take(group->tasks, task, false)) {
+    return false;
+  }
+  --group->depth;
+  --m_groupTasks;
+  return true;
+}
+
+bool Scheduler::takeAnyGroup(ExecuteTask& task) {
+  Group* best = pickGroup(false);
+  if (nullptr != best && takeGroup(best, task)) {
+    //默认组空闲时不攒额度，之后有任务了和这个组从同一个虚拟时间开始竞争
+    Group* def = m_groups[kDefaultGroup];
+    uint64_t vtime = best->vtime;
+    if (!best->priority && def->vtime < vtime) {
+      def->vtime = vtime;
+    }
+    return true;
+  }
+  //最合适的组里只有还没切出去的协程，或者被别的线程抢先取走了，再看看其他组
+  int count = m_groupCount;
+  for (int i = 1; i < count; ++i) {
+    if (m_groups[i] != best && takeGroup(m_groups[i], task)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Scheduler::Group* Scheduler::beginGroupTask(const ExecuteTask& task) {
+  Group* group = m_groups[task.group < 0 ? kDefaultGroup : task.group];
+  ++group->executed;
+  if (0 != task.enqueue_ns) {
+    uint64_t wait = NowInNs() - task.enqueue_ns;
+    group->wait_ns += wait;
+    uint64_t max = group->max_wait_ns;
+    while (wait > max && !group->max_wait_ns.compare_exchange_weak(max, wait)) {
+    }
+  }
+  return group;
+}
+
+void Scheduler::chargeGroup(Group* group, uint64_t run_ns) {
+  group->run_ns += run_ns;
+  group->vtime += run_ns * kDefaultGroupWeight / group->weight;
+}
+
+void Scheduler::setThreadRange(size_t min, size_t max) {
+  size_t limit = kMaxThreads - (-1 != m_rootThreadId ? 1 : 0);
+  max = std::min(std::max<size_t>(max, 1), limit);
+  m_minThreads = std::min(min, max);
+  m_maxThreads = max;
+  ELOG_INFO(g_logger) << "scheduler " << m_name << " thread range: ["
+                      << m_minThreads << ", " << m_maxThreads << "]";
+}
+
+void Scheduler::applyThreadRange(
+    const std::map<std::string, std::vector<uint32_t>>& ranges) {
+  auto it = ranges.find(m_name);
+  if (it == ranges.end() || it->second.size() != 2) {
+    setThreadRange(m_defaultThreads, m_defaultThreads);
+    return;
+  }
+  setThreadRange(it->second[0], it->second[1]);
+}
+
+bool Scheduler::setAffinity(const std::string& spec) {
+  //只用进程本来就能用的CPU，容器和taskset限制之外的CPU绑不上
+  //allowed是有序的，spec中的CPU保持用户给的顺序，第i个线程用第i个
+  std::vector<int> allowed = GetThreadAffinity(getpid());
+  auto usable = [&allowed](const std::vector<int>& cpus) {
+    std::vector<int> res;
+    for (int cpu : cpus) {
+      if (std::binary_search(allowed.begin(), allowed.end(), cpu)) {
+        res.push_back(cpu);
+      }
+    }
+    return res;
+  };
+  std::vector<std::vector<int>> sets;
+  if (!spec.empty()) {
+    if (0 == spec.compare(0, 5, "node:")) {
+      for (int node : ParseCpuList(spec.substr(5))) {
+        std::vector<int> cpus = usable(GetNumaNodeCpus(node));
+        if (!cpus.empty()) {
+          sets.push_back(cpus);
+        }
+      }
+    } else {
+      for (int cpu : usable(ParseCpuList(spec))) {
+        sets.push_back({cpu});
+      }
+    }
+    if (sets.empty()) {
+      ELOG_ERROR(g_logger) << "scheduler " << m_name
+                           << " invalid affinity: " << spec
+                           << ", allowed cpus: " << CpuListToString(allowed);
+      return false;
+    }
+  }
+
+  MutexType::LockGuard lock(m_mutex);
+  m_affinity = spec;
+  m_affinityCpus.swap(sets);
+  //已经在运行的线程立即迁移，取消绑定时恢复成进程可用的所有CPU
+  size_t offset = -1 != m_rootThreadId ? 1 : 0;
+  size_t n = m_workerSlots;
+  for (size_t i = offset; i < n; ++i) {
+    Worker* w = m_workers[i];
+    if (nullptr == w->thread || w->exited) {
+      continue;
+    }
+    std::vector<int> cpus = workerCpus(w->index - offset);
+    SetThreadAffinity(w->thread->getId(), cpus.empty() ? allowed : cpus);
+  }
+  ELOG_INFO(g_logger) << "scheduler " << m_name << " affinity: "
+                      << (spec.empty() ? "none" : spec);
+  return true;
+}
+
+std::string Scheduler::getAffinity() const {
+  MutexType::LockGuard lock(m_mutex);
+  return m_affinity;
+}
+
+std::vector<Scheduler::ThreadPlacement> Scheduler::getPlacement() const {
+  std::vector<ThreadPlacement> result;
+  MutexType::LockGuard lock(m_mutex);
+  size_t n = m_workerSlots;
+  for (size_t i = 0; i < n; ++i) {
+    Worker* w = m_workers[i];
+    int tid = w->thread_id;
+    if (-1 == tid || w->exited) {
+      continue;
+    }
+    ThreadPlacement p;
+    p.thread_id = tid;
+    p.cpus = GetThreadAffinity(tid);
+    p.cpu = GetThreadCpu(tid);
+    p.node = -1 == p.cpu ? -1 : GetNumaNodeOfCpu(p.cpu);
+    result.push_back(std::move(p));
+  }
+  return result;
+}
+
+void Scheduler::applyAffinity(
+    const std::map<std::string, std::string>& specs) {
+  auto it = specs.find(m_name);
+  std::string spec = it == specs.end() ? "" : it->second;
+  if (spec == getAffinity()) {
+    return;
+  }
+  setAffinity(spec);
+}
+
+std::vector<int> Scheduler::workerCpus(size_t index) const {
+  if (m_affinityCpus.empty()) {
+    return {};
+  }
+  return m_affinityCpus[index % m_affinityCpus.size()];
+}
+
+bool Scheduler::adjustThreads(Worker* worker) {
+  size_t min = m_minThreads;
+  size_t max = m_maxThreads;
+  size_t threads = m_threadCount;
+  if ((min == max && threads == max) || m_stopping) {
+    return false;
+  }
+  uint64_t now = East::GetCurrentTimeInMs();
+  uint64_t last = m_lastAdjust;
+  if (now < last + g_scheduler_elastic_interval->getValue() ||
+      !m_lastAdjust.compare_exchange_strong(last, now)) {
+    return false;
+  }
+
+  //空闲比例取平滑值，偶尔空闲一下不会马上减少线程。
+  //做检查的线程自己正在调度循环里，看的是其他线程中空闲的比例，也就是它退出后剩下的线程够不够用
+  size_t idle = m_idleThreadCount;
+  size_t others = threads > 1 ? threads - 1 : 1;
+  uint32_t ratio = std::min<size_t>(idle * 1000 / others, 1000);
+  uint32_t smooth = (m_idleRatio * 3 + ratio) / 4;
+  m_idleRatio = smooth;
+  size_t pending = m_pendingTasks;
+
+  if (threads < min || (threads < max && 0 == idle && pending > threads)) {
+    MutexType::LockGuard lock(m_mutex);
+    if (!m_stopping && m_threadCount < m_maxThreads) {
+      addThread();
+    }
+    return false;
+  }
+  bool shrink = threads > max || (threads > min && 0 == pending && smooth > 500);
+  //只有做检查的线程自己退出，调用者线程和有共享栈协程绑定的线程不能退出
+  if (!shrink || East::GetThreadId() == m_rootThreadId ||
+      Fiber::HasBoundFibers()) {
+    return false;
+  }
+  MutexType::LockGuard lock(m_mutex);
+  if (m_stopping || m_threadCount <= std::min(m_minThreads, m_maxThreads)) {
+    return false;
+  }
+  --m_threadCount;
+  worker->retiring = true;
+  m_idleRatio = 0;  //重新观察一段时间再减下一个
+  ELOG_INFO(g_logger) << "scheduler " << m_name << " retire thread "
+                      << East::GetThreadId() << ", threads: " << m_threadCount;
+  return true;
+}
+
+void Scheduler::addThread() {
+  Worker* w = nullptr;
+  size_t n = m_workerSlots;
+  for (size_t i = 0; i < n; ++i) {
+    if (m_workers[i]->exited) {
+      w = m_workers[i];
+      break;
+    }
+  }
+  if (nullptr != w) {
+    //线程已经交出了所有任务，join不会等待
+    w->thread->join();
+    m_threads.erase(std::find(m_threads.begin(), m_threads.end(), w->thread));
+    w->thread.reset();
+    w->thread_id = -1;
+    w->tick = 0;
+    w->parked = false;
+    w->tickled = false;
+    w->count_wakeup = false;
+    w->refilled = false;
+    w->exited = false;
+    w->retiring = false;
+  } else {
+    if (n >= kMaxThreads) {
+      return;
+    }
+    w = new Worker;
+    w->owner = this;
+    w->index = n;
+    w->batch.reserve(m_batchSize);
+    m_workers[n] = w;
+    m_workerSlots = n + 1;  //先放好再计数，遍历的线程看到计数时一定能看到队列
+  }
+  ++m_threadCount;
+  startThread(w);
+  ELOG_INFO(g_logger) << "scheduler " << m_name << " add thread "
+                      << w->thread->getId() << ", threads: " << m_threadCount;
+}
+
+void Scheduler::retire(Worker* worker) {
+  std::deque<ExecuteTask> tasks;
+  tasks.swap(worker->deadline);
+  for (auto& t : worker->pinned) {
+    tasks.push_back(std::move(t));
+  }
+  worker->pinned.clear();
+  {
+    SpinLock::LockGuard lock(worker->lock);
+    for (auto& t : worker->local) {
+      tasks.push_back(std::move(t));
+    }
+    worker->local.clear();
+    worker->local_size = 0;
+  }
+  for (auto& t : tasks) {
+    t.thread_id = -1;
+    pushGlobal(std::move(t));
+  }
+  handOffInbox(worker);
+  if (!tasks.empty()) {
+    tickle();
+  }
+  MutexType::LockGuard lock(m_mutex);
+  auto it = std::find(m_threadIds.begin(), m_threadIds.end(),
+                      East::GetThreadId());
+  if (it != m_threadIds.end()) {
+    m_threadIds.erase(it);
+  }
+}
+
+void Scheduler::handOffInbox(Worker* worker) {
+  Worker::Node* n = worker->inbox.exchange(nullptr, std::memory_order_acquire);
+  if (nullptr == n) {
+    return;
+  }
+  //栈是后进先出的，反转之后按提交顺序交出去
+  Worker::Node* head = nullptr;
+  while (nullptr != n) {
+    Worker::Node* next = n->next;
+    n->next = head;
+    head = n;
+    n = next;
+  }
+  while (nullptr != head) {
+    Worker::Node* next = head->next;
+    head->task.thread_id = -1;
+    pushGlobal(std::move(head->task));
+    delete head;
+    head = next;
+  }
+  tickle();
+}
+
+uint64_t Scheduler::adjustInterval() const {
+  if (m_minThreads == m_maxThreads && m_threadCount == m_maxThreads) {
+    return 0;
+  }
+  return std::max<uint64_t>(1, g_scheduler_elastic_interval->getValue());
+}
+
+bool Scheduler::retiring() const {
+  Worker* worker = currentWorker();
+  return nullptr != worker && worker->retiring;
+}
+
+Scheduler::DeadlineStats Scheduler::getDeadlineStats() const {
+  DeadlineStats stats;
+  stats.scheduled = m_deadlineScheduled;
+  stats.expired = m_deadlineExpired;
+  stats.dropped = m_deadlineDropped;
+  return stats;
+}
+
 /**
  * @brief 检查是否有空闲线程
  * @return 有空闲线程返回true，否则返回false
@@ -380,6 +1560,10 @@ void Scheduler::tickle() {
   ELOG_DEBUG(g_logger) << "tickle";
 }
 
+void Scheduler::tickleThread(size_t) {
+  tickle();
+}
+
 /**
  * @brief 空闲处理协程的虚函数
  * 
@@ -395,7 +1579,7 @@ void Scheduler::tickle() {
  */
 void Scheduler::idle() {
   ELOG_DEBUG(g_logger) << "idle";
-  while (!stopping()) {
+  while (!stopping() && !retiring()) {
     East::Fiber::YieldToHold();
   }
 }
@@ -407,15 +1591,14 @@ void Scheduler::idle() {
  * 停止条件检查逻辑：
  * 1. 自动停止标志已设置（m_autoStop = true）
  * 2. 停止标志已设置（m_stopping = true）
- * 3. 任务队列为空（m_tasks.empty()）
+ * 3. 所有队列都为空（m_pendingTasks == 0）
  * 4. 没有活跃线程（m_activeThreadCount == 0）
  * 
  * 只有同时满足以上四个条件，调度器才会真正停止。
  * 这种设计确保了所有任务都能被正确处理完成。
  */
 bool Scheduler::stopping() {
-  MutexType::LockGuard lock(m_mutex);
-  return m_autoStop && m_stopping && m_tasks.empty() &&
+  return m_autoStop && m_stopping && 0 == m_pendingTasks &&
          m_activeThreadCount == 0;
 }
 
@@ -0,0 +1,132 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 23:05:20
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 23:05:20
+ */
+
+#include "ShardGroup.h"
+#include <unistd.h>
+#include "Config.h"
+#include "Elog.h"
+#include "FiberSync.h"
+#include "util.h"
+
+namespace East {
+
+static East::Logger::sptr g_logger = ELOG_NAME("system");
+
+static ConfigVar<uint32_t>::sptr g_shard_count = Config::Lookup<uint32_t>(
+    "shard.count", 0, "shards of a ShardGroup, 0 means number of cpus");
+
+static ConfigVar<bool>::sptr g_shard_pin_cpu = Config::Lookup<bool>(
+    "shard.pin_cpu", true, "pin each shard thread to its own cpu");
+
+static thread_local ShardGroup* t_shard_group = nullptr;
+static thread_local int t_shard_index = -1;
+
+ShardGroup::ShardGroup(size_t count, const std::string& name) : m_name(name) {
+  //taskset或者容器限制了CPU时只用进程能用的那些
+  std::vector<int> cpus = GetThreadAffinity(getpid());
+  if (cpus.empty()) {
+    cpus.push_back(0);
+  }
+  if (0 == count) {
+    count = g_shard_count->getValue();
+  }
+  if (0 == count) {
+    count = cpus.size();
+  }
+  bool pin = g_shard_pin_cpu->getValue();
+
+  //分片线程在IOManager构造时就启动了，等它们都记下自己的下标再返回
+  WaitGroup ready(count);
+  for (size_t i = 0; i < count; ++i) {
+    m_shards.emplace_back(
+        new IOManager(1, false, m_name + "_" + std::to_string(i)));
+    //scheduler.affinity里单独配置了这个分片的话按配置放置
+    if (pin && m_shards[i]->getAffinity().empty()) {
+      m_shards[i]->setAffinity(std::to_string(cpus[i % cpus.size()]));
+    }
+    m_shards[i]->schedule([this, i, &ready]() {
+      t_shard_group = this;
+      t_shard_index = i;
+      ready.done();
+    });
+  }
+  ready.wait();
+  ELOG_INFO(g_logger) << "shard group " << m_name << " started, shards: "
+                      << count << ", pin_cpu: " << pin;
+}
+
+ShardGroup::~ShardGroup() {
+  stop();
+}
+
+int ShardGroup::GetCurrentIndex() {
+  return t_shard_index;
+}
+
+ShardGroup* ShardGroup::GetCurrent() {
+  return t_shard_group;
+}
+
+Future<void> ShardGroup::broadcast(std::function<void(size_t)> f) {
+  std::vector<Future<void>> futures;
+  futures.reserve(m_shards.size());
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    futures.push_back(call(i, [f, i]() { f(i); }));
+  }
+  return WhenAll(futures);
+}
+
+bool ShardGroup::serve(const std::vector<Address::sptr>& addrs,
+                       const ServerFactory& factory) {
+  //端口为0时每个socket会各自分到一个端口，其他分片改用分片0实际绑定到的地址
+  std::vector<Address::sptr> bind_addrs = addrs;
+  for (size_t i = 0; i < m_shards.size(); ++i) {
+    //监听socket在分片自己的线程上创建，由hook登记为非阻塞，accept只挂起协程
+    TcpServer::sptr server;
+    bool ok = call(i, [&]() {
+                std::vector<Address::sptr> fails;
+                server = factory(m_shards[i].get());
+                server->setReusePort(true);
+                return server->bind(bind_addrs, fails);
+              }).get();
+    if (!ok) {
+      ELOG_ERROR(g_logger) << "shard " << m_name << "_" << i << " bind fail";
+      for (auto& s : m_servers) {
+        s->stop();
+      }
+      m_servers.clear();
+      return false;
+    }
+    if (0 == i) {
+      bind_addrs.clear();
+      for (auto& sock : server->getSocks()) {
+        bind_addrs.push_back(sock->getLocalAddr());
+      }
+    }
+    m_servers.push_back(server);
+  }
+  for (auto& s : m_servers) {
+    s->start();
+  }
+  return true;
+}
+
+void ShardGroup::stop() {
+  if (m_stopped) {
+    return;
+  }
+  m_stopped = true;
+  for (auto& s : m_servers) {
+    s->stop();
+  }
+  m_servers.clear();
+  for (auto& shard : m_shards) {
+    shard->stop();
+  }
+}
+
+}  // namespace East
@@ -138,6 +138,13 @@ bool Socket::init(int sock) {
   return false;
 }
 
+void Socket::setReusePort(bool v) {
+  m_reuse_port = v;
+  if (isValid()) {
+    setOption(SOL_SOCKET, SO_REUSEPORT, static_cast<int>(v));
+  }
+}
+
 bool Socket::bind(const Address::sptr addr) {
   if (!isValid()) {
     newSocket();
@@ -442,6 +449,9 @@ void Socket::initSocket() {
   //TODO
   int val = 1;
   setOption(SOL_SOCKET, SO_REUSEADDR, val);  //端口释放之后可以立即被复用
+  if (m_reuse_port) {
+    setOption(SOL_SOCKET, SO_REUSEPORT, val);
+  }
   if (m_type == SOCK_STREAM) {
     setOption(
         IPPROTO_TCP, TCP_NODELAY,
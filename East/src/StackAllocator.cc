@@ -0,0 +1,250 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 10:12:35
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 10:12:35
+ */
+
+#include "StackAllocator.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <atomic>
+#include <sstream>
+#include <utility>
+#include <vector>
+#include "Config.h"
+#include "Elog.h"
+
+namespace East {
+
+static Logger::sptr g_logger = ELOG_NAME("system");
+
+static ConfigVar<std::string>::sptr g_fiber_stack_allocator =
+    Config::Lookup<std::string>("fiber.stack_allocator", "mmap",
+                                "fiber stack allocator, mmap or malloc");
+
+static ConfigVar<uint32_t>::sptr g_fiber_stack_pool_size =
+    Config::Lookup<uint32_t>("fiber.stack_pool_size", 64,
+                             "max cached stacks per thread and stack size");
+
+static ConfigVar<bool>::sptr g_fiber_stack_madvise_idle = Config::Lookup<bool>(
+    "fiber.stack_madvise_idle", false,
+    "release physical memory of cached stacks with MADV_DONTNEED");
+
+static std::atomic<uint64_t> s_hits{0};
+static std::atomic<uint64_t> s_misses{0};
+static std::atomic<uint64_t> s_mapped_bytes{0};
+static std::atomic<uint64_t> s_cached_bytes{0};
+static std::atomic<uint64_t> s_resident_bytes{0};
+
+static size_t PageSize() {
+  static size_t s_page_size = sysconf(_SC_PAGESIZE);
+  return s_page_size;
+}
+
+static size_t RoundUpToPage(size_t size) {
+  size_t page = PageSize();
+  return (size + page - 1) / page * page;
+}
+
+static void UnmapStack(void* p, size_t size) {
+  size_t page = PageSize();
+  if (munmap(static_cast<char*>(p) - page, size + page)) {
+    ELOG_ERROR(g_logger) << "munmap stack failed, errno: " << errno
+                         << ", strerror: " << strerror(errno);
+  }
+  s_mapped_bytes -= size;
+}
+
+/**
+ * @brief 线程私有的空闲栈链表，按栈大小分组
+ *
+ * 栈大小的种类通常只有一两种，所以直接用vector线性查找
+ */
+struct StackCache {
+  struct Entry {
+    void* stack;
+    bool madvised;  ///< 进入链表时是否已经MADV_DONTNEED
+  };
+
+  std::vector<std::pair<size_t, std::vector<Entry>>> lists;
+
+  std::vector<Entry>& get(size_t size) {
+    for (auto& i : lists) {
+      if (i.first == size) {
+        return i.second;
+      }
+    }
+    lists.emplace_back(size, std::vector<Entry>{});
+    return lists.back().second;
+  }
+
+  //线程退出时，把缓存的栈还给内核
+  ~StackCache();
+};
+
+//缓存析构之后线程里仍可能有协程被销毁（例如thread_local持有的协程），这时直接munmap
+static thread_local bool t_stack_cache_destroyed = false;
+static thread_local StackCache t_stack_cache;
+
+StackCache::~StackCache() {
+  t_stack_cache_destroyed = true;
+  for (auto& [size, entries] : lists) {
+    for (auto& e : entries) {
+      s_cached_bytes -= size;
+      if (!e.madvised) {
+        s_resident_bytes -= size;
+      }
+      UnmapStack(e.stack, size);
+    }
+  }
+}
+
+void* MallocStackAllocator::alloc(size_t size) {
+  return malloc(size);
+}
+
+void MallocStackAllocator::dealloc(void* p, size_t size) {
+  free(p);
+}
+
+void* MmapStackAllocator::alloc(size_t size) {
+  size = RoundUpToPage(size);
+  auto& entries = t_stack_cache.get(size);
+  if (!entries.empty()) {
+    StackCache::Entry e = entries.back();
+    entries.pop_back();
+    ++s_hits;
+    s_cached_bytes -= size;
+    if (e.madvised) {
+      s_resident_bytes += size;
+    }
+    return e.stack;
+  }
+
+  //低地址处多映射一页作为保护页，栈是从高地址向低地址增长的
+  size_t page = PageSize();
+  void* base = mmap(nullptr, size + page, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  if (base == MAP_FAILED) {
+    ELOG_ERROR(g_logger) << "mmap stack failed, size: " << size
+                         << ", errno: " << errno
+                         << ", strerror: " << strerror(errno);
+    return nullptr;
+  }
+  if (mprotect(base, page, PROT_NONE)) {
+    ELOG_ERROR(g_logger) << "mprotect guard page failed, errno: " << errno
+                         << ", strerror: " << strerror(errno);
+    munmap(base, size + page);
+    return nullptr;
+  }
+
+  ++s_misses;
+  s_mapped_bytes += size;
+  s_resident_bytes += size;
+  return static_cast<char*>(base) + page;
+}
+
+void MmapStackAllocator::dealloc(void* p, size_t size) {
+  if (nullptr == p) {
+    return;
+  }
+  size = RoundUpToPage(size);
+  if (t_stack_cache_destroyed) {
+    s_resident_bytes -= size;
+    UnmapStack(p, size);
+    return;
+  }
+  auto& entries = t_stack_cache.get(size);
+  if (entries.size() >= g_fiber_stack_pool_size->getValue()) {
+    s_resident_bytes -= size;
+    UnmapStack(p, size);
+    return;
+  }
+
+  bool madvised = false;
+  if (g_fiber_stack_madvise_idle->getValue()) {
+    madvised = (0 == madvise(p, size, MADV_DONTNEED));
+  }
+  if (madvised) {
+    s_resident_bytes -= size;
+  }
+  s_cached_bytes += size;
+  entries.push_back({p, madvised});
+}
+
+MmapStackAllocator::Stats MmapStackAllocator::GetStats() {
+  Stats stats;
+  stats.hits = s_hits;
+  stats.misses = s_misses;
+  stats.mapped_bytes = s_mapped_bytes;
+  stats.cached_bytes = s_cached_bytes;
+  stats.resident_bytes = s_resident_bytes;
+  return stats;
+}
+
+std::string MmapStackAllocator::StatsToString() {
+  Stats stats = GetStats();
+  std::stringstream ss;
+  ss << "hits: " << stats.hits << ", misses: " << stats.misses
+     << ", mapped bytes: " << stats.mapped_bytes
+     << ", cached bytes: " << stats.cached_bytes
+     << ", resident bytes: " << stats.resident_bytes;
+  return ss.str();
+}
+
+//分配器对象故意不释放，线程退出时thread_local的缓存可能还会用到它们
+static StackAllocator* GetMallocAllocator() {
+  static StackAllocator* s_allocator = new MallocStackAllocator;
+  return s_allocator;
+}
+
+static StackAllocator* GetMmapAllocator() {
+  static StackAllocator* s_allocator = new MmapStackAllocator;
+  return s_allocator;
+}
+
+static std::atomic<StackAllocator*> s_config_allocator{nullptr};
+static std::atomic<StackAllocator*> s_custom_allocator{nullptr};
+
+static StackAllocator* AllocatorFromName(const std::string& name) {
+  if (name == "malloc") {
+    return GetMallocAllocator();
+  }
+  if (name != "mmap") {
+    ELOG_ERROR(g_logger) << "unknown fiber.stack_allocator: " << name
+                         << ", use mmap";
+  }
+  return GetMmapAllocator();
+}
+
+struct _StackAllocatorIniter {
+  _StackAllocatorIniter() {
+    s_config_allocator = AllocatorFromName(g_fiber_stack_allocator->getValue());
+    g_fiber_stack_allocator->addListener(
+        [](const std::string& old_v, const std::string& new_v) {
+          ELOG_INFO(g_logger) << "fiber stack allocator changed from "
+                              << old_v << " to " << new_v;
+          s_config_allocator = AllocatorFromName(new_v);
+        });
+  }
+};
+
+static _StackAllocatorIniter s_stack_allocator_initer;
+
+StackAllocator* StackAllocator::GetDefault() {
+  StackAllocator* custom = s_custom_allocator;
+  if (nullptr != custom) {
+    return custom;
+  }
+  StackAllocator* configured = s_config_allocator;
+  return nullptr != configured ? configured : GetMmapAllocator();
+}
+
+void StackAllocator::SetDefault(StackAllocator* allocator) {
+  s_custom_allocator = allocator;
+}
+
+}  // namespace East
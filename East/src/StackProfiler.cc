@@ -0,0 +1,257 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 12:20:11
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 12:20:11
+ */
+
+#include "StackProfiler.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+#include "Config.h"
+#include "Mutex.h"
+#include "StackAllocator.h"
+#include "util.h"
+
+namespace East {
+
+static ConfigVar<bool>::sptr g_fiber_stack_profile = Config::Lookup<bool>(
+    "fiber.stack_profile", false,
+    "poison fiber stacks and sample their high-water mark on TERM");
+
+static ConfigVar<uint32_t>::sptr g_fiber_stack_profile_rate =
+    Config::Lookup<uint32_t>(
+        "fiber.stack_profile_rate", 16,
+        "sample one in this many new or reused fibers, 1 samples every fiber");
+
+static ConfigVar<bool>::sptr g_fiber_stack_autotune = Config::Lookup<bool>(
+    "fiber.stack_autotune", false,
+    "choose smaller stack size classes from sampled high-water marks, "
+    "only with an allocator that has guard pages");
+
+static ConfigVar<uint32_t>::sptr g_fiber_stack_autotune_min_samples =
+    Config::Lookup<uint32_t>("fiber.stack_autotune_min_samples", 100,
+                             "samples needed before a call site is tuned");
+
+static ConfigVar<uint32_t>::sptr g_fiber_stack_autotune_margin =
+    Config::Lookup<uint32_t>(
+        "fiber.stack_autotune_margin", 100,
+        "headroom over the sampled high-water mark, in percent");
+
+static const uint64_t kPoison = 0xEAEAEAEAEAEAEAEAull;
+
+//前kClassCount - 1个档位的大小，最后一档是默认栈大小
+static const uint32_t s_classes[StackProfiler::kClassCount - 1] = {
+    32 * 1024, 64 * 1024, 128 * 1024, 256 * 1024};
+
+//采样窗口：最大档位再多一页，水位到了窗口底部就说明超过了最大档位
+static const size_t kWindow = 256 * 1024 + 4096;
+
+/**
+ * @brief 每个调用点的采样结果，创建后一直保留，Reset只清零
+ */
+struct SiteStats {
+  const std::type_info* type{nullptr};
+  std::atomic<uint64_t> samples{0};
+  std::atomic<uint64_t> max_used{0};
+  std::atomic<uint64_t> total_used{0};
+  std::atomic<uint64_t> hist[StackProfiler::kClassCount]{};  ///< 使用量落在各档位的次数
+  std::atomic<uint64_t> tuned{0};         ///< 使用调优后的栈运行的次数
+  std::atomic<uint32_t> default_size{0};  ///< 最近一次采样时的默认栈大小
+  std::atomic<uint32_t> need_class{0};    ///< 最高水位加余量后需要的档位下标，只增不减
+};
+
+static RWLock s_mutex;  ///< 只保护s_sites的插入和遍历
+static std::unordered_map<std::type_index, std::unique_ptr<SiteStats>> s_sites;
+static thread_local std::unordered_map<std::type_index, SiteStats*> t_sites;
+static thread_local uint32_t t_sample_tick = 0;
+
+//先查线程私有的缓存，每个线程每个调用点只进一次全局表
+static SiteStats* GetSite(const std::type_info& site) {
+  std::type_index key(site);
+  auto it = t_sites.find(key);
+  if (it != t_sites.end()) {
+    return it->second;
+  }
+  SiteStats* stats = nullptr;
+  {
+    RWLock::WLockGuard lock(s_mutex);
+    std::unique_ptr<SiteStats>& p = s_sites[key];
+    if (!p) {
+      p.reset(new SiteStats);
+      p->type = &site;
+    }
+    stats = p.get();
+  }
+  t_sites.emplace(key, stats);
+  return stats;
+}
+
+static size_t ClassIndex(size_t used) {
+  for (size_t i = 0; i < StackProfiler::kClassCount - 1; ++i) {
+    if (used <= s_classes[i]) {
+      return i;
+    }
+  }
+  return StackProfiler::kClassCount - 1;
+}
+
+static std::string ClassLabel(size_t i) {
+  std::stringstream ss;
+  if (i < StackProfiler::kClassCount - 1) {
+    ss << "<=" << s_classes[i] / 1024 << "K";
+  } else {
+    ss << ">" << s_classes[i - 1] / 1024 << "K";
+  }
+  return ss.str();
+}
+
+//按发布的档位选择栈大小，0表示使用默认栈大小
+static uint32_t ChooseClass(const SiteStats& stats, uint32_t default_size) {
+  //先读样本数，看到的档位至少包含了这些样本
+  if (stats.samples.load(std::memory_order_acquire) <
+      g_fiber_stack_autotune_min_samples->getValue()) {
+    return 0;
+  }
+  size_t i = stats.need_class.load(std::memory_order_relaxed);
+  if (i >= StackProfiler::kClassCount - 1 || s_classes[i] >= default_size) {
+    return 0;
+  }
+  return s_classes[i];
+}
+
+bool StackProfiler::IsEnabled() {
+  return g_fiber_stack_profile->getValue() ||
+         g_fiber_stack_autotune->getValue();
+}
+
+bool StackProfiler::ShouldSample() {
+  if (!IsEnabled()) {
+    return false;
+  }
+  uint32_t rate = g_fiber_stack_profile_rate->getValue();
+  return rate <= 1 || 0 == t_sample_tick++ % rate;
+}
+
+uint32_t StackProfiler::ChooseStackSize(const std::type_info& site,
+                                        uint32_t default_size) {
+  //malloc分配的栈没有保护页，调小之后溢出会悄悄踩坏别的内存
+  if (!g_fiber_stack_autotune->getValue() ||
+      !StackAllocator::GetDefault()->hasGuardPage()) {
+    return default_size;
+  }
+  uint32_t size = ChooseClass(*GetSite(site), default_size);
+  return 0 != size ? size : default_size;
+}
+
+void StackProfiler::Poison(void* p, size_t size) {
+  size_t window = std::min(size, kWindow);
+  memset(static_cast<char*>(p) + size - window,
+         static_cast<int>(kPoison & 0xff), window);
+}
+
+size_t StackProfiler::Measure(const void* stack, size_t size) {
+  //栈从高地址向低地址增长，从窗口底部开始找第一个被改写的字
+  size_t window = std::min(size, kWindow);
+  const uint64_t* end = static_cast<const uint64_t*>(stack) + size / sizeof(uint64_t);
+  const uint64_t* p = end - window / sizeof(uint64_t);
+  while (p < end && *p == kPoison) {
+    ++p;
+  }
+  return (end - p) * sizeof(uint64_t);
+}
+
+void StackProfiler::Record(const std::type_info& site, size_t used,
+                           size_t stack_size, uint32_t default_size) {
+  SiteStats& stats = *GetSite(site);
+  uint64_t max_used = stats.max_used.load(std::memory_order_relaxed);
+  while (used > max_used &&
+         !stats.max_used.compare_exchange_weak(max_used, used)) {
+  }
+  max_used = std::max<uint64_t>(max_used, used);
+  stats.total_used += used;
+  ++stats.hist[ClassIndex(used)];
+  stats.default_size = default_size;
+  if (stack_size < default_size) {
+    ++stats.tuned;
+  }
+
+  //档位只增不减，并发采样时先算完的较小档位不会覆盖较大的
+  uint64_t need =
+      max_used + max_used * g_fiber_stack_autotune_margin->getValue() / 100;
+  uint32_t need_class = ClassIndex(need);
+  uint32_t cur = stats.need_class.load(std::memory_order_relaxed);
+  while (need_class > cur &&
+         !stats.need_class.compare_exchange_weak(cur, need_class)) {
+  }
+  stats.samples.fetch_add(1, std::memory_order_release);
+}
+
+std::string StackProfiler::Dump() {
+  std::vector<const SiteStats*> sites;
+  {
+    RWLock::RLockGuard lock(s_mutex);
+    for (auto& i : s_sites) {
+      if (0 != i.second->samples) {
+        sites.push_back(i.second.get());
+      }
+    }
+  }
+  std::sort(sites.begin(), sites.end(),
+            [](const SiteStats* a, const SiteStats* b) {
+              return a->samples > b->samples;
+            });
+
+  uint64_t total[kClassCount]{};
+  std::stringstream ss;
+  ss << "fiber stack profile, sites: " << sites.size() << "\n";
+  for (auto s : sites) {
+    uint32_t default_size = s->default_size;
+    uint32_t chosen = ChooseClass(*s, default_size);
+    uint64_t max_used = s->max_used;
+    ss << Demangle(s->type->name()) << "\n"
+       << "    samples: " << s->samples << ", max: "
+       << (max_used >= kWindow ? ">=" : "") << max_used
+       << ", avg: " << s->total_used / std::max<uint64_t>(1, s->samples)
+       << ", stack: " << (0 != chosen ? chosen : default_size)
+       << (0 != chosen ? " (tuned)" : " (default)")
+       << ", tuned runs: " << s->tuned << "\n    hist:";
+    for (size_t i = 0; i < kClassCount; ++i) {
+      uint64_t n = s->hist[i];
+      total[i] += n;
+      ss << " " << ClassLabel(i) << ":" << n;
+    }
+    ss << "\n";
+  }
+  ss << "total hist:";
+  for (size_t i = 0; i < kClassCount; ++i) {
+    ss << " " << ClassLabel(i) << ":" << total[i];
+  }
+  ss << "\n";
+  return ss.str();
+}
+
+void StackProfiler::Reset() {
+  //调用点留在表里，线程私有的缓存仍然有效，只清零统计
+  RWLock::RLockGuard lock(s_mutex);
+  for (auto& i : s_sites) {
+    SiteStats& s = *i.second;
+    s.samples = 0;
+    s.max_used = 0;
+    s.total_used = 0;
+    for (auto& h : s.hist) {
+      h = 0;
+    }
+    s.tuned = 0;
+    s.need_class = 0;
+  }
+}
+
+}  // namespace East
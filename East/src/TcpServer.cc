@@ -20,6 +20,15 @@ static East::ConfigVar<uint64_t>::sptr g_tcp_server_read_timeout =
     East::Config::Lookup("tcp_server.read_timeout", uint64_t(60 * 1000 * 2),
                          "tcp server read timeout");
 
+/**
+ * @brief 客户端连接是否在共享栈上处理
+ * 
+ * 大量空闲长连接时打开，挂起的连接只占用实际用到的栈内容
+ */
+static East::ConfigVar<bool>::sptr g_tcp_server_shared_stack =
+    East::Config::Lookup("tcp_server.shared_stack", false,
+                         "handle clients on shared fiber stacks");
+
 /**
  * @brief 系统日志记录器
  */
@@ -30,7 +39,7 @@ static East::Logger::sptr g_logger = ELOG_NAME("system");
  * 
  * 初始化TCP服务器的各个成员变量：
  * - 设置工作协程管理器和接受连接协程管理器
- * - 从配置读取默认读取超时时间
+ * - 从配置读取默认读取超时时间和是否使用共享栈
  * - 设置默认服务器名称
  * - 初始化停止标志为true
  */
@@ -38,6 +47,7 @@ TcpServer::TcpServer(East::IOManager* worker, East::IOManager* accept_worker)
     : m_worker(worker),
       m_acceptWorker(accept_worker),
       m_readTimeout(g_tcp_server_read_timeout->getValue()),
+      m_sharedStack(g_tcp_server_shared_stack->getValue()),
       m_name("East/1.0.0"),
       m_isStop(true) {}
 
@@ -87,6 +97,7 @@ bool TcpServer::bind(const std::vector<Address::sptr>& addrs,
                      std::vector<Address::sptr>& fails) {
   for (auto& addr : addrs) {
     Socket::sptr sock = Socket::CreateTCP(addr);
+    sock->setReusePort(m_reusePort);
     if (!sock->bind(addr)) {
       ELOG_ERROR(g_logger) << "bind fail errno: " << errno
                            << " strerror: " << strerror(errno) << " addr:[ "
@@ -191,7 +202,8 @@ void TcpServer::startAccept(Socket::sptr sock) {
     if (client) {
       client->setRecvTimeout(m_readTimeout);
       m_worker->schedule(
-          std::bind(&TcpServer::handleClient, shared_from_this(), client));
+          std::bind(&TcpServer::handleClient, shared_from_this(), client), -1,
+          m_sharedStack);
     } else {
       ELOG_DEBUG(g_logger) << "Accept error: " << errno
                            << " strerrno: " << strerror(errno);
@@ -48,12 +48,24 @@ void* Thread::run(void* arg) {
   return 0;
 }
 
-Thread::Thread(const std::string& name, std::function<void()> cb)
+Thread::Thread(const std::string& name, std::function<void()> cb,
+               const std::vector<int>& cpus)
     : m_name(name), m_cb(cb) {
   if (name.empty()) {
     m_name = "UNKOWN";
   }
-  int res = pthread_create(&m_thread, nullptr, &run, this);
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  if (!cpus.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+      CPU_SET(cpu, &set);
+    }
+    pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+  }
+  int res = pthread_create(&m_thread, &attr, &run, this);
+  pthread_attr_destroy(&attr);
   if (0 != res) {
     ELOG_ERROR(g_logger) << "pthread_create failed, ret value: " << res
                          << ", name: " << name;
@@ -180,7 +180,7 @@ void TimerManager::listExpiredCb(std::vector<std::function<void()>>& cbs) {
 
   auto i = 0u;
   for (const auto& p : expired) {
-    cbs[i] = p->m_cb;
+    cbs[i++] = p->m_cb;
     if (p->m_recurring) {
       // auto old_execute_time = p->m_execute_time;
       p->m_execute_time = now_ms + p->m_period;
@@ -5,9 +5,15 @@
  * @Last Modified time: 2025-08-21 00:31:31
  */
 
+#include <ctype.h>
+#include <cxxabi.h>
 #include <execinfo.h>
+#include <sched.h>
+#include <stdio.h>
 #include <sys/time.h>
+#include <algorithm>
 #include <chrono>
+#include <fstream>
 #include <iomanip>
 #include <sstream>
 #include <sys/types.h>
@@ -95,6 +101,155 @@ std::string TimeSinceEpochToString(uint64_t tm) {
   return ss.str();
 }
 
+std::string Demangle(const char* name) {
+  int status = 0;
+  char* p = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if (0 != status || nullptr == p) {
+    return name;
+  }
+  std::string res(p);
+  free(p);
+  return res;
+}
+
+std::vector<int> ParseCpuList(const std::string& str) {
+  std::vector<int> cpus;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (item.empty()) {
+      continue;
+    }
+    int first = -1;
+    int last = -1;
+    //%n记下解析到的位置，没有解析到末尾说明后面还有多余的字符
+    int end = -1;
+    int size = static_cast<int>(item.size());
+    if (2 != sscanf(item.c_str(), "%d-%d%n", &first, &last, &end) ||
+        size != end) {
+      end = -1;
+      if (1 != sscanf(item.c_str(), "%d%n", &first, &end) || size != end) {
+        return {};
+      }
+      last = first;
+    }
+    if (first < 0 || last < first || last >= CPU_SETSIZE) {
+      return {};
+    }
+    for (int i = first; i <= last; ++i) {
+      cpus.push_back(i);
+    }
+  }
+  //保留第一次出现的顺序，调用者可能按顺序把线程分到各个CPU上
+  std::vector<int> res;
+  std::vector<bool> seen(CPU_SETSIZE, false);
+  for (int cpu : cpus) {
+    if (!seen[cpu]) {
+      seen[cpu] = true;
+      res.push_back(cpu);
+    }
+  }
+  return res;
+}
+
+std::string CpuListToString(const std::vector<int>& cpus) {
+  std::stringstream ss;
+  for (size_t i = 0; i < cpus.size();) {
+    size_t j = i;
+    while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+      ++j;
+    }
+    ss << (0 == i ? "" : ",") << cpus[i];
+    if (j > i) {
+      ss << "-" << cpus[j];
+    }
+    i = j + 1;
+  }
+  return ss.str();
+}
+
+bool SetThreadAffinity(pid_t tid, const std::vector<int>& cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &set);
+  }
+  if (sched_setaffinity(tid, sizeof(set), &set)) {
+    ELOG_ERROR(g_logger) << "sched_setaffinity(" << tid << ", "
+                         << CpuListToString(cpus) << ") err: " << errno
+                         << ", strerror: " << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+std::vector<int> GetThreadAffinity(pid_t tid) {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(tid, sizeof(set), &set)) {
+    return cpus;
+  }
+  for (int i = 0; i < CPU_SETSIZE; ++i) {
+    if (CPU_ISSET(i, &set)) {
+      cpus.push_back(i);
+    }
+  }
+  return cpus;
+}
+
+int GetThreadCpu(pid_t tid) {
+  if (0 == tid) {
+    return sched_getcpu();
+  }
+  std::ifstream ifs("/proc/self/task/" + std::to_string(tid) + "/stat");
+  std::string stat;
+  if (!std::getline(ifs, stat)) {
+    return -1;
+  }
+  //第二个字段是带括号的线程名，可能有空格，从最后一个')'之后开始数，processor是第39个字段
+  size_t pos = stat.rfind(')');
+  if (std::string::npos == pos) {
+    return -1;
+  }
+  std::stringstream ss(stat.substr(pos + 1));
+  std::string field;
+  for (int i = 3; i <= 39; ++i) {
+    if (!(ss >> field)) {
+      return -1;
+    }
+  }
+  return atoi(field.c_str());
+}
+
+int GetNumaNodeOfCpu(int cpu) {
+  std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+  auto dir = opendir(path.c_str());
+  if (nullptr == dir) {
+    return -1;
+  }
+  int node = -1;
+  struct dirent* dp = nullptr;
+  while (nullptr != (dp = readdir(dir))) {
+    if (0 == strncmp(dp->d_name, "node", 4) && isdigit(dp->d_name[4])) {
+      node = atoi(dp->d_name + 4);
+      break;
+    }
+  }
+  closedir(dir);
+  return node;
+}
+
+std::vector<int> GetNumaNodeCpus(int node) {
+  std::ifstream ifs("/sys/devices/system/node/node" + std::to_string(node) +
+                    "/cpulist");
+  std::string list;
+  if (!std::getline(ifs, list)) {
+    return {};
+  }
+  return ParseCpuList(list);
+}
+
 void FSUtil::ListAllFile(std::vector<std::string>& files, const std::string& path, const std::string& suffix){
   if(access(path.c_str(), 0) != 0) {
     return ;
@@ -0,0 +1,89 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 11:20:31
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 11:20:31
+ */
+
+//对比ucontext和手写汇编两种上下文切换的开销
+//用法: fiber_switch_bench [切换次数]
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include "../East/include/Elog.h"
+#include "../East/include/Fiber.h"
+#include "../East/include/FiberContext.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+static const size_t kStackSize = 128 * 1024;
+
+template <class Ctx>
+struct RawSwitch {
+  static Ctx s_main;
+  static Ctx s_co;
+
+  static void Loop() {
+    while (true) {
+      s_co.swap(s_main);
+    }
+  }
+
+  //返回每次切换(单向)的纳秒数
+  static double Run(uint64_t n) {
+    std::vector<char> stack(kStackSize);
+    s_co.make(stack.data(), stack.size(), &RawSwitch::Loop);
+    s_main.swap(s_co);  //预热，第一次切入
+    auto begin = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < n; ++i) {
+      s_main.swap(s_co);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+    return ns / (n * 2);
+  }
+};
+
+template <class Ctx>
+Ctx RawSwitch<Ctx>::s_main;
+template <class Ctx>
+Ctx RawSwitch<Ctx>::s_co;
+
+//Fiber::resume/yield，包含状态维护等开销
+static double RunFiber(uint64_t n) {
+  East::Fiber::GetThis();
+  East::Fiber::sptr fiber(new East::Fiber(
+      [n]() {
+        for (uint64_t i = 0; i < n; ++i) {
+          East::Fiber::YieldToReady();
+        }
+      },
+      kStackSize, false));
+  auto begin = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < n; ++i) {
+    fiber->resume();
+  }
+  auto end = std::chrono::steady_clock::now();
+  fiber->resume();  //让协程执行完
+  double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+  return ns / (n * 2);
+}
+
+//每次切换的耗时和每秒的切换次数
+static void Report(const char* name, double ns) {
+  ELOG_INFO(g_logger) << name << ns << " ns/switch, " << 1e9 / ns / 1e6
+                      << " M switches/s";
+}
+
+int main(int argc, char** argv) {
+  uint64_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+
+  ELOG_INFO(g_logger) << "switches: " << n * 2;
+  Report("ucontext: ", RawSwitch<East::UContext>::Run(n));
+#if EAST_FIBER_ASM_CONTEXT
+  Report("asm:      ", RawSwitch<East::AsmContext>::Run(n));
+#endif
+  Report(EAST_FIBER_ASM_CONTEXT ? "Fiber(asm): " : "Fiber(ucontext): ",
+         RunFiber(n));
+  return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 19:32:10
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 19:32:10
+ */
+
+//对比调度器全局队列的两种实现：std::list + Mutex 和无锁有界队列MpmcQueue
+//每个线程交替入队、出队，统计1~64个线程下的总吞吐
+//用法: mpmc_queue_bench [每个线程的操作次数]
+#include <sched.h>
+#include <stdlib.h>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <vector>
+#include "../East/include/Elog.h"
+#include "../East/include/MpmcQueue.h"
+#include "../East/include/Mutex.h"
+#include "../East/include/Thread.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+using Task = std::function<void()>;
+
+//任务可能被其他线程执行，不能引用入队线程栈上的变量
+static thread_local uint64_t t_sink = 0;
+
+struct ListQueue {
+  bool push(Task&& t) {
+    East::Mutex::LockGuard lock(mutex);
+    tasks.push_back(std::move(t));
+    return true;
+  }
+
+  bool pop(Task& t) {
+    East::Mutex::LockGuard lock(mutex);
+    if (tasks.empty()) {
+      return false;
+    }
+    t = std::move(tasks.front());
+    tasks.pop_front();
+    return true;
+  }
+
+  East::Mutex mutex;
+  std::list<Task> tasks;
+};
+
+//返回每秒的操作数(入队和出队各算一次)，单位百万
+template <class Queue>
+static double Run(Queue& queue, size_t threads, uint64_t n) {
+  std::vector<East::Thread::sptr> workers;
+  auto begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < threads; ++i) {
+    workers.push_back(std::make_shared<East::Thread>(
+        "bench_" + std::to_string(i), [&queue, n]() {
+          Task t;
+          for (uint64_t j = 0; j < n; ++j) {
+            Task task = [j]() { t_sink += j; };
+            //取不到时让出CPU，和调度器取不到任务时去做别的事一样，不原地自旋
+            while (!queue.push(std::move(task))) {
+              sched_yield();
+            }
+            while (!queue.pop(t)) {
+              sched_yield();
+            }
+            t();
+          }
+        }));
+  }
+  for (auto& w : workers) {
+    w->join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  double sec = std::chrono::duration<double>(end - begin).count();
+  return threads * n * 2 / sec / 1e6;
+}
+
+int main(int argc, char** argv) {
+  uint64_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 200000;
+
+  ELOG_INFO(g_logger) << "ops per thread: " << n * 2;
+  for (size_t threads = 1; threads <= 64; threads *= 2) {
+    ListQueue list;
+    East::MpmcQueue<Task> ring(4096);
+    double list_ops = Run(list, threads, n);
+    double ring_ops = Run(ring, threads, n);
+    ELOG_INFO(g_logger) << "threads: " << threads << ", list+mutex: "
+                        << list_ops << " Mops/s, mpmc ring: " << ring_ops
+                        << " Mops/s";
+  }
+  return 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 16:15:20
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 16:15:20
+ */
+#include <errno.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../East/include/Cancellation.h"
+#include "../East/include/Elog.h"
+#include "../East/include/FdManager.h"
+#include "../East/include/FiberSync.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+#include "../East/include/util.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+//阻塞在recv上的协程被取消后立刻返回ECANCELED
+void test_cancel_recv(East::IOManager& iom) {
+  int fds[2];
+  EAST_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  East::FdMgr::GetInst()->getFd(fds[0], true);  //交给FdManager，recv才会走hook
+  auto token = East::CancellationToken::Create();
+  East::WaitGroup wg(2);
+  iom.schedule(token->bind([&]() {
+    char buf[16];
+    uint64_t start = East::GetCurrentTimeInMs();
+    ssize_t n = recv(fds[0], buf, sizeof(buf), 0);
+    int err = errno;
+    uint64_t used = East::GetCurrentTimeInMs() - start;
+    ELOG_INFO(g_logger) << "test_cancel_recv n: " << n << ", errno: " << err
+                        << ", used: " << used << "ms";
+    EAST_ASSERT(-1 == n && ECANCELED == err && used < 1000);
+    //已经取消，之后需要等待的IO直接返回
+    n = recv(fds[0], buf, sizeof(buf), 0);
+    EAST_ASSERT(-1 == n && ECANCELED == errno);
+    wg.done();
+  }));
+  iom.schedule([&]() {
+    usleep(100 * 1000);
+    token->cancel();
+    wg.done();
+  });
+  wg.wait();
+  close(fds[0]);
+  close(fds[1]);
+}
+
+//cancelAfter作为截止时间，取消子任务里的sleep
+void test_cancel_sleep(East::IOManager& iom) {
+  East::WaitGroup wg(1);
+  iom.schedule([&]() {
+    auto token = East::CancellationToken::Create();
+    East::CancellationToken::SetThis(token);
+    token->cancelAfter(100);
+    East::WaitGroup children(3);
+    for (int i = 0; i < 3; ++i) {
+      East::IOManager::GetThis()->schedule(
+          East::CancellationToken::Bind([&children]() {
+            uint64_t start = East::GetCurrentTimeInMs();
+            int res = usleep(10 * 1000 * 1000);
+            EAST_ASSERT(-1 == res && ECANCELED == errno);
+            EAST_ASSERT(East::GetCurrentTimeInMs() - start < 1000);
+            children.done();
+          }));
+    }
+    children.wait();
+    EAST_ASSERT(token->isCancelled());
+    ELOG_INFO(g_logger) << "test_cancel_sleep end";
+    wg.done();
+  });
+  wg.wait();
+}
+
+void test_child_token() {
+  auto parent = East::CancellationToken::Create();
+  auto child = parent->createChild();
+  int called = 0;
+  uint64_t id = child->addCallback([&called]() { ++called; });
+  uint64_t removed = child->addCallback([&called]() { called += 100; });
+  child->removeCallback(removed);
+  auto other = parent->createChild();
+  other->cancel();
+  EAST_ASSERT(!parent->isCancelled() && !child->isCancelled());
+  parent->cancel();
+  EAST_ASSERT(child->isCancelled() && 1 == called && 0 != id);
+  //已经取消的令牌直接执行回调
+  EAST_ASSERT(0 == child->addCallback([&called]() { ++called; }));
+  EAST_ASSERT(2 == called);
+  ELOG_INFO(g_logger) << "test_child_token end";
+}
+
+int main() {
+  test_child_token();
+  East::IOManager iom(2, false, "cancel");
+  test_cancel_recv(iom);
+  test_cancel_sleep(iom);
+  ELOG_INFO(g_logger) << "test cancellation end";
+  return 0;
+}
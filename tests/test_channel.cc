@@ -0,0 +1,123 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 14:52:40
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 14:52:40
+ */
+#include <atomic>
+#include <string>
+#include "../East/include/Channel.h"
+#include "../East/include/Elog.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+//多个生产者写有缓冲通道，多个消费者读到通道关闭
+void test_pipeline(East::IOManager& iom) {
+  East::Channel<int> ch(16);
+  East::FiberSemaphore producers_done, consumers_done;
+  std::atomic<int64_t> sum{0};
+  for (int i = 0; i < 4; ++i) {
+    iom.schedule([&]() {
+      for (int j = 1; j <= 1000; ++j) {
+        EAST_ASSERT(ch.send(j));
+      }
+      producers_done.notify();
+    });
+    iom.schedule([&]() {
+      int v = 0;
+      while (ch.recv(v)) {
+        sum += v;
+      }
+      consumers_done.notify();
+    });
+  }
+  for (int i = 0; i < 4; ++i) {
+    producers_done.wait();
+  }
+  ch.close();
+  EAST_ASSERT(!ch.send(0));
+  for (int i = 0; i < 4; ++i) {
+    consumers_done.wait();
+  }
+  ELOG_INFO(g_logger) << "test_pipeline sum: " << sum.load();
+  EAST_ASSERT(sum == 4 * 1000 * 1001 / 2);
+}
+
+//无缓冲通道在两个调度器之间来回传递
+void test_unbuffered_ping_pong(East::IOManager& a, East::IOManager& b) {
+  East::Channel<std::string> ping, pong;
+  East::FiberSemaphore done;
+  a.schedule([&]() {
+    std::string s;
+    for (int i = 0; i < 1000; ++i) {
+      EAST_ASSERT(ping.send("ping"));
+      EAST_ASSERT(pong.recv(s) && s == "pong");
+    }
+    done.notify();
+  });
+  b.schedule([&]() {
+    std::string s;
+    for (int i = 0; i < 1000; ++i) {
+      EAST_ASSERT(ping.recv(s) && s == "ping");
+      EAST_ASSERT(pong.send("pong"));
+    }
+    done.notify();
+  });
+  done.wait();
+  done.wait();
+  ELOG_INFO(g_logger) << "test_unbuffered_ping_pong end";
+}
+
+void test_select(East::IOManager& iom) {
+  East::Channel<int> a, b(1);
+  East::Channel<std::string> c;
+  East::FiberSemaphore done;
+  iom.schedule([&]() {
+    int x = 0;
+    std::string s;
+    //都没有数据，超时
+    int idx = East::Select({a.recvCase(&x), c.recvCase(&s)}, 50);
+    EAST_ASSERT(-1 == idx);
+    //非阻塞的select
+    EAST_ASSERT(-1 == East::Select({a.recvCase(&x)}, 0));
+
+    EAST_ASSERT(b.send(7));
+    idx = East::Select({a.recvCase(&x), b.recvCase(&x)});
+    EAST_ASSERT(1 == idx && 7 == x);
+
+    //b的缓冲区空着，发送的case直接完成
+    bool ok = false;
+    idx = East::Select({c.recvCase(&s), b.sendCase(8, &ok)});
+    EAST_ASSERT(1 == idx && ok);
+
+    //等待其他协程往c发送
+    idx = East::Select({a.recvCase(&x), c.recvCase(&s)}, 1000);
+    EAST_ASSERT(1 == idx && "hello" == s);
+
+    //关闭的通道也算就绪，ok为false
+    idx = East::Select({a.recvCase(&x, &ok), c.recvCase(&s)}, 1000);
+    EAST_ASSERT(0 == idx && !ok);
+    done.notify();
+  });
+  iom.schedule([&]() {
+    usleep(100 * 1000);
+    EAST_ASSERT(c.send("hello"));
+    usleep(100 * 1000);
+    a.close();
+  });
+  done.wait();
+  EAST_ASSERT(1 == b.size());
+  ELOG_INFO(g_logger) << "test_select end";
+}
+
+int main() {
+  East::IOManager iom(3, false, "channel");
+  East::IOManager other(2, false, "channel_other");
+  test_pipeline(iom);
+  test_unbuffered_ping_pong(iom, other);
+  test_select(iom);
+  ELOG_INFO(g_logger) << "test channel end";
+  return 0;
+}
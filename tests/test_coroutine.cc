@@ -0,0 +1,107 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 17:12:45
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 17:12:45
+ */
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <stdexcept>
+#include <string>
+#include "../East/include/Coroutine.h"
+#include "../East/include/Elog.h"
+#include "../East/include/Macro.h"
+#include "../East/include/util.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+East::Task<int> add_one(int v) {
+  co_await East::SleepFor(10);
+  co_return v + 1;
+}
+
+East::Task<void> fail() {
+  co_await East::ScheduleOn(East::Scheduler::GetThis());
+  throw std::runtime_error("fail");
+}
+
+//协程之间co_await，异常在co_await处抛出
+East::Task<int> chain() {
+  int v = 0;
+  for (int i = 0; i < 10; ++i) {
+    v = co_await add_one(v);
+  }
+  bool thrown = false;
+  try {
+    co_await fail();
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  EAST_ASSERT(thrown);
+  co_return v;
+}
+
+//在两个IOManager之间来回切换
+East::Task<int> hop(East::IOManager* a, East::IOManager* b) {
+  int hops = 0;
+  for (int i = 0; i < 5; ++i) {
+    co_await East::ScheduleOn(b);
+    EAST_ASSERT(East::Scheduler::GetThis() == b);
+    co_await East::ScheduleOn(a);
+    EAST_ASSERT(East::Scheduler::GetThis() == a);
+    hops += 2;
+  }
+  co_return hops;
+}
+
+//等待非阻塞fd可读，对端由有栈协程写入
+East::Task<std::string> read_line(int fd) {
+  if (!co_await East::WaitEvent(fd, East::IOManager::READ, 1000)) {
+    co_return "";
+  }
+  char buf[64];
+  ssize_t n = read(fd, buf, sizeof(buf));
+  co_return std::string(buf, n > 0 ? n : 0);
+}
+
+East::Task<bool> wait_timeout(int fd) {
+  uint64_t start = East::GetCurrentTimeInMs();
+  bool ready = co_await East::WaitEvent(fd, East::IOManager::READ, 50);
+  EAST_ASSERT(East::GetCurrentTimeInMs() - start < 1000);
+  co_return ready;
+}
+
+//协程里等待有栈协程的Future
+East::Task<int> await_future(East::IOManager* iom) {
+  int v = co_await East::Async(iom, []() {
+    usleep(10 * 1000);
+    return 42;
+  });
+  co_return v;
+}
+
+int main() {
+  East::IOManager iom(2, false, "co_a");
+  East::IOManager other(1, false, "co_b");
+
+  EAST_ASSERT(10 == East::Spawn(&iom, chain()).get());
+  EAST_ASSERT(10 == East::Spawn(&iom, hop(&iom, &other)).get());
+  EAST_ASSERT(42 == East::Spawn(&iom, await_future(&iom)).get());
+
+  int fds[2];
+  EAST_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+  East::Future<bool> timeout = East::Spawn(&iom, wait_timeout(fds[0]));
+  EAST_ASSERT(!timeout.get());
+  East::Future<std::string> line = East::Spawn(&iom, read_line(fds[0]));
+  iom.schedule([&]() {
+    usleep(20 * 1000);
+    EAST_ASSERT(5 == write(fds[1], "hello", 5));
+  });
+  EAST_ASSERT("hello" == line.get());
+  close(fds[0]);
+  close(fds[1]);
+  ELOG_INFO(g_logger) << "test coroutine end";
+  return 0;
+}
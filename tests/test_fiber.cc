@@ -1,29 +1,186 @@
 /*
  * @Author: Xudong0722 
  * @Date: 2025-04-01 22:54:06 
- * @Last Modified by:   Xudong0722 
- * @Last Modified time: 2025-04-01 22:54:06 
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 10:40:12
  */
+#include "../East/include/Config.h"
 #include "../East/include/Elog.h"
 #include "../East/include/Fiber.h"
+#include "../East/include/FiberLocal.h"
+#include "../East/include/Macro.h"
+#include "../East/include/StackAllocator.h"
+#include "../East/include/StackProfiler.h"
+#include <string.h>
+#include <vector>
 
 East::Logger::sptr g_logger = ELOG_ROOT();
 
+//不在调度器里的协程没有人把它设为HOLD，用YieldToReady让出，之后才能再次resume
 void func() {
   ELOG_INFO(g_logger) << "func begin";
-  East::Fiber::YieldToHold();
+  East::Fiber::YieldToReady();
   ELOG_INFO(g_logger) << "func end";
-  East::Fiber::YieldToHold();
+  East::Fiber::YieldToReady();
+}
+
+void test_stack_pool() {
+  auto before = East::MmapStackAllocator::GetStats();
+  for (int i = 0; i < 1000; ++i) {
+    East::Fiber::sptr fiber =
+        std::make_shared<East::Fiber>([]() {}, 0, false);
+    fiber->resume();
+  }
+  //同一个线程里反复创建销毁协程，除了第一次以外都应该命中空闲链表
+  auto after = East::MmapStackAllocator::GetStats();
+  ELOG_INFO(g_logger) << "stack pool: "
+                      << East::MmapStackAllocator::StatsToString();
+  EAST_ASSERT(after.hits - before.hits >= 999);
+  EAST_ASSERT(after.misses - before.misses <= 1);
+}
+
+void test_fiber_pool() {
+  auto before = East::Fiber::GetPoolStats();
+  int count = 0;
+  for (int i = 0; i < 1000; ++i) {
+    East::Fiber::sptr fiber =
+        East::Fiber::Create([&count]() { ++count; }, 0, false);
+    fiber->resume();
+    East::Fiber::Recycle(fiber);
+  }
+  EAST_ASSERT(count == 1000);
+  //除了第一次，之后都应该复用同一个协程
+  auto after = East::Fiber::GetPoolStats();
+  ELOG_INFO(g_logger) << "fiber pool: " << East::Fiber::PoolStatsToString();
+  EAST_ASSERT(after.hits - before.hits >= 999);
+  EAST_ASSERT(after.misses - before.misses == 1);
+}
+
+static volatile char g_sink = 0;
+
+void test_stack_autotune() {
+  East::Config::Lookup<bool>("fiber.stack_autotune")->setValue(true);
+  East::Config::Lookup<uint32_t>("fiber.stack_autotune_min_samples")
+      ->setValue(10);
+  East::Config::Lookup<uint32_t>("fiber.stack_profile_rate")->setValue(1);
+  auto shallow = []() {
+    char buf[1024];
+    memset(buf, 1, sizeof(buf));
+    g_sink = buf[sizeof(buf) - 1];
+  };
+  auto deep = []() {
+    char buf[512 * 1024];
+    memset(buf, 1, sizeof(buf));
+    g_sink = buf[sizeof(buf) - 1];
+  };
+  for (int i = 0; i < 10; ++i) {
+    East::Fiber::sptr f1 = East::Fiber::Create(shallow, 0, false);
+    f1->resume();
+    East::Fiber::sptr f2 = East::Fiber::Create(deep, 0, false);
+    f2->resume();
+  }
+  //浅的调用点换成最小的档位，深的保持默认栈大小
+  East::Fiber::sptr f1 = East::Fiber::Create(shallow, 0, false);
+  East::Fiber::sptr f2 = East::Fiber::Create(deep, 0, false);
+  EAST_ASSERT(f1->getStackSize() == 32 * 1024);
+  EAST_ASSERT(f2->getStackSize() == 1024 * 1024);
+  f1->resume();
+  f2->resume();
+
+  //malloc分配的栈没有保护页，不能调小
+  static East::MallocStackAllocator s_malloc_allocator;
+  East::StackAllocator::SetDefault(&s_malloc_allocator);
+  East::Fiber::sptr f3 = East::Fiber::Create(shallow, 0, false);
+  EAST_ASSERT(f3->getStackSize() == 1024 * 1024);
+  f3->resume();
+  East::StackAllocator::SetDefault(nullptr);
+  ELOG_INFO(g_logger) << East::StackProfiler::Dump() << "sink: " << (int)g_sink;
+  East::Config::Lookup<bool>("fiber.stack_autotune")->setValue(false);
+}
+
+struct LocalValue {
+  static int s_alive;
+  int value{0};
+  LocalValue() { ++s_alive; }
+  ~LocalValue() { --s_alive; }
+};
+int LocalValue::s_alive = 0;
+
+static East::FiberLocal<LocalValue> s_local;
+
+void test_fiber_local() {
+  //两个协程交替执行，各自的局部变量互不影响，结束后自动析构
+  std::vector<East::Fiber::sptr> fibers;
+  for (int i = 1; i <= 2; ++i) {
+    fibers.emplace_back(East::Fiber::Create(
+        [i]() {
+          s_local->value = i;
+          East::Fiber::YieldToReady();
+          EAST_ASSERT(s_local->value == i);
+        },
+        0, false));
+  }
+  for (int r = 0; r < 2; ++r) {
+    for (auto& f : fibers) {
+      f->resume();
+    }
+    if (r == 0) {
+      EAST_ASSERT(LocalValue::s_alive == 2);
+      EAST_ASSERT(!s_local.has());  //主协程没有访问过
+    }
+  }
+  EAST_ASSERT(LocalValue::s_alive == 0);
+  ELOG_INFO(g_logger) << "fiber local ok";
+}
+
+void test_shared_stack() {
+  //协程数远多于共享栈数，交替执行时栈上的局部变量要能被正确换出换入
+  const int fiber_count = 100;
+  const int rounds = 10;
+  std::vector<East::Fiber::sptr> fibers;
+  for (int i = 0; i < fiber_count; ++i) {
+    fibers.emplace_back(std::make_shared<East::Fiber>(
+        [i, rounds]() {
+          int values[256];
+          for (int k = 0; k < 256; ++k) {
+            values[k] = i * 1000 + k;
+          }
+          for (int r = 0; r < rounds; ++r) {
+            East::Fiber::YieldToReady();
+            for (int k = 0; k < 256; ++k) {
+              EAST_ASSERT(values[k] == i * 1000 + k);
+            }
+          }
+        },
+        0, false, true));
+  }
+  for (int r = 0; r <= rounds; ++r) {
+    for (auto& f : fibers) {
+      f->resume();
+    }
+  }
+  for (auto& f : fibers) {
+    EAST_ASSERT(f->getState() == East::Fiber::TERM);
+  }
+  ELOG_INFO(g_logger) << "shared stack: " << fiber_count << " fibers ok";
 }
 
 int main() {
   East::Fiber::GetThis();
+  test_stack_pool();
+  test_fiber_pool();
+  test_stack_autotune();
+  test_fiber_local();
+  test_shared_stack();
   ELOG_INFO(g_logger) << "main begin";
-  East::Fiber::sptr fiber(new East::Fiber(func));
-  fiber->resume();
-  ELOG_INFO(g_logger) << "main after swapIn";
-  fiber->resume();
-  ELOG_INFO(g_logger) << "main after end";
-  fiber->resume();
-  ELOG_INFO(g_logger) << "main after end2";
-}
\ No newline at end of file
+  East::Fiber::sptr fiber(new East::Fiber(func, 0, false));
+  int resumes = 0;
+  while (fiber->getState() != East::Fiber::TERM) {
+    fiber->resume();
+    ++resumes;
+    ELOG_INFO(g_logger) << "main after resume " << resumes;
+  }
+  EAST_ASSERT(3 == resumes);
+  ELOG_INFO(g_logger) << "main end";
+  return 0;
+}
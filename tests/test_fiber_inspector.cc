@@ -0,0 +1,105 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 17:52:31
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 17:52:31
+ */
+#include <sys/socket.h>
+#include <unistd.h>
+#include "../East/include/Elog.h"
+#include "../East/include/FdManager.h"
+#include "../East/include/FiberInspector.h"
+#include "../East/include/FiberSync.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+static East::FiberMutex g_mutex;
+
+void park_on_recv(int fd, East::WaitGroup* wg) {
+  char buf[16];
+  EAST_ASSERT(recv(fd, buf, sizeof(buf), 0) > 0);
+  wg->done();
+}
+
+void park_on_mutex(East::WaitGroup* wg) {
+  East::FiberMutex::LockGuard lock(g_mutex);
+  wg->done();
+}
+
+const East::FiberInfo* find_reason(const std::vector<East::FiberInfo>& fibers,
+                                   const std::string& reason) {
+  for (auto& f : fibers) {
+    if (f.wait_reason == reason) {
+      return &f;
+    }
+  }
+  return nullptr;
+}
+
+//调度器析构之后还挂起着的协程，导出时不能再访问它的调度器
+void test_dead_scheduler() {
+  East::FiberMutex* mutex = new East::FiberMutex;  //一直锁着，挂起的协程不会再被唤醒，故意不释放
+  mutex->lock();
+  {
+    East::IOManager iom(1, false, "dead");
+    iom.schedule([mutex]() { East::FiberMutex::LockGuard lock(*mutex); });
+    usleep(50 * 1000);
+  }
+  std::vector<East::FiberInfo> fibers = East::FiberInspector::Collect(true);
+  const East::FiberInfo* parked = find_reason(fibers, "mutex");
+  EAST_ASSERT(nullptr != parked && parked->scheduler.empty());
+  ELOG_INFO(g_logger) << East::FiberInspector::DumpText(true, false);
+}
+
+void test_inspect() {
+  East::IOManager iom(2, false, "inspect");
+  int fds[2];
+  EAST_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  East::FdMgr::GetInst()->getFd(fds[0], true);
+
+  East::WaitGroup wg(3);
+  g_mutex.lock();
+  iom.schedule(std::bind(park_on_recv, fds[0], &wg));
+  iom.schedule(std::bind(park_on_mutex, &wg));
+  iom.schedule([&wg]() {
+    usleep(300 * 1000);
+    wg.done();
+  });
+  usleep(100 * 1000);
+
+  std::vector<East::FiberInfo> fibers = East::FiberInspector::Collect(true);
+  ELOG_INFO(g_logger) << East::FiberInspector::DumpText(true);
+  const East::FiberInfo* io = find_reason(fibers, "io");
+  EAST_ASSERT(nullptr != io);
+  EAST_ASSERT(io->fd == fds[0] && io->event == East::IOManager::READ);
+  EAST_ASSERT(io->scheduler == "inspect" && io->parked_ms >= 50);
+  EAST_ASSERT(!io->backtrace.empty());
+  bool found = false;
+  for (auto& frame : io->backtrace) {
+    found = found || std::string::npos != frame.find("park_on_recv");
+  }
+#if EAST_FIBER_ASM_CONTEXT
+  EAST_ASSERT(found);
+#endif
+  EAST_ASSERT(nullptr != find_reason(fibers, "mutex"));
+  EAST_ASSERT(nullptr != find_reason(fibers, "sleep"));
+
+  std::string json = East::FiberInspector::DumpJson(true, false);
+  EAST_ASSERT('[' == json.front() && ']' == json.back());
+  EAST_ASSERT(std::string::npos != json.find("\"wait_reason\":\"mutex\""));
+
+  g_mutex.unlock();
+  EAST_ASSERT(1 == write(fds[1], "x", 1));
+  wg.wait();
+  close(fds[0]);
+  close(fds[1]);
+}
+
+int main() {
+  test_inspect();
+  test_dead_scheduler();
+  ELOG_INFO(g_logger) << "test fiber inspector end";
+  return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 14:02:31
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 14:02:31
+ */
+#include <atomic>
+#include <list>
+#include "../East/include/Elog.h"
+#include "../East/include/FiberSync.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+static const int kFibers = 100;
+static const int kLoops = 1000;
+
+void test_mutex(East::IOManager& iom) {
+  East::FiberMutex mutex;
+  East::FiberSemaphore done;  //主线程不在调度器中，会阻塞线程等待
+  int64_t count = 0;
+  for (int i = 0; i < kFibers; ++i) {
+    iom.schedule([&]() {
+      for (int j = 0; j < kLoops; ++j) {
+        East::FiberMutex::LockGuard lock(mutex);
+        ++count;
+        if (0 == j % 100) {
+          East::Fiber::YieldToReady();  //持锁让出，制造竞争
+        }
+      }
+      done.notify();
+    });
+  }
+  for (int i = 0; i < kFibers; ++i) {
+    done.wait();
+  }
+  ELOG_INFO(g_logger) << "test_mutex count: " << count;
+  EAST_ASSERT(count == kFibers * kLoops);
+}
+
+void test_rwlock(East::IOManager& iom) {
+  East::FiberRWLock rwlock;
+  East::FiberSemaphore done;
+  int64_t a = 0, b = 0;
+  std::atomic<int64_t> reads{0};
+  for (int i = 0; i < kFibers; ++i) {
+    bool writer = 0 == i % 10;
+    iom.schedule([&, writer]() {
+      for (int j = 0; j < kLoops / 10; ++j) {
+        if (writer) {
+          East::FiberRWLock::WLockGuard lock(rwlock);
+          ++a;
+          East::Fiber::YieldToReady();
+          ++b;
+        } else {
+          East::FiberRWLock::RLockGuard lock(rwlock);
+          EAST_ASSERT(a == b);
+          ++reads;
+          if (0 == j % 10) {
+            East::Fiber::YieldToReady();
+          }
+        }
+      }
+      done.notify();
+    });
+  }
+  for (int i = 0; i < kFibers; ++i) {
+    done.wait();
+  }
+  ELOG_INFO(g_logger) << "test_rwlock writes: " << a
+                      << ", reads: " << reads.load();
+  EAST_ASSERT(a == b && a == kFibers / 10 * kLoops / 10);
+}
+
+void test_condvar(East::IOManager& iom) {
+  East::FiberMutex mutex;
+  East::FiberCondVar cond;
+  East::FiberSemaphore done;
+  std::list<int> queue;
+  int64_t sum = 0;
+  for (int i = 0; i < kFibers / 2; ++i) {
+    iom.schedule([&]() {  //消费者，收到-1结束
+      while (true) {
+        East::FiberMutex::LockGuard lock(mutex);
+        cond.wait(mutex, [&]() { return !queue.empty(); });
+        int v = queue.front();
+        queue.pop_front();
+        if (v < 0) {
+          break;
+        }
+        sum += v;
+      }
+      done.notify();
+    });
+  }
+  for (int i = 0; i < kFibers / 2; ++i) {
+    iom.schedule([&]() {  //生产者
+      for (int j = 1; j <= kLoops; ++j) {
+        East::FiberMutex::LockGuard lock(mutex);
+        queue.push_back(j);
+        cond.notifyOne();
+      }
+      done.notify();
+    });
+  }
+  for (int i = 0; i < kFibers / 2; ++i) {
+    done.wait();
+  }
+  {
+    East::FiberMutex::LockGuard lock(mutex);
+    for (int i = 0; i < kFibers / 2; ++i) {
+      queue.push_back(-1);
+    }
+    cond.notifyAll();
+  }
+  for (int i = 0; i < kFibers / 2; ++i) {
+    done.wait();
+  }
+  ELOG_INFO(g_logger) << "test_condvar sum: " << sum;
+  EAST_ASSERT(sum == int64_t(kFibers / 2) * kLoops * (kLoops + 1) / 2);
+}
+
+void test_semaphore(East::IOManager& iom) {
+  East::FiberSemaphore sem(4);
+  East::FiberSemaphore done;
+  std::atomic<int> running{0};
+  std::atomic<int> max_running{0};
+  for (int i = 0; i < kFibers; ++i) {
+    iom.schedule([&]() {
+      for (int j = 0; j < kLoops / 10; ++j) {
+        sem.wait();
+        int n = ++running;
+        int m = max_running.load();
+        while (n > m && !max_running.compare_exchange_weak(m, n))
+          ;
+        East::Fiber::YieldToReady();
+        --running;
+        sem.notify();
+      }
+      done.notify();
+    });
+  }
+  for (int i = 0; i < kFibers; ++i) {
+    done.wait();
+  }
+  ELOG_INFO(g_logger) << "test_semaphore max running: " << max_running.load();
+  EAST_ASSERT(max_running.load() <= 4);
+}
+
+int main() {
+  East::IOManager iom(3, false, "fiber_sync");
+  test_mutex(iom);
+  test_rwlock(iom);
+  test_condvar(iom);
+  test_semaphore(iom);
+  ELOG_INFO(g_logger) << "test fiber sync end";
+  return 0;
+}
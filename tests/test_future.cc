@@ -0,0 +1,129 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 15:32:02
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 15:32:02
+ */
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "../East/include/Elog.h"
+#include "../East/include/Future.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+//模拟一次后端调用
+static int call_backend(int i) {
+  usleep(1000 * (i % 10));
+  return i * 2;
+}
+
+//一个协程扇出100个调用，等待全部完成
+void test_fan_out(East::IOManager& iom) {
+  East::WaitGroup done(1);
+  iom.schedule([&]() {
+    std::vector<East::Future<int>> futures;
+    for (int i = 0; i < 100; ++i) {
+      futures.push_back(East::Async(&iom, [i]() { return call_backend(i); }));
+    }
+    East::WhenAll(futures).wait();
+    int sum = 0;
+    for (auto& f : futures) {
+      EAST_ASSERT(f.isReady());
+      sum += f.get();
+    }
+    ELOG_INFO(g_logger) << "test_fan_out sum: " << sum;
+    EAST_ASSERT(sum == 99 * 100);
+    done.done();
+  });
+  done.wait();
+}
+
+void test_then(East::IOManager& iom) {
+  East::Promise<int> p;
+  East::Future<std::string> f =
+      p.getFuture()
+          .then([](const int& v) { return v + 1; })
+          .then([](const int& v) { return std::to_string(v); });
+  East::Future<void> g =
+      f.then([](const std::string& s) {
+         if (s == "42") {
+           throw std::runtime_error("bad answer");
+         }
+       }).then([]() { ELOG_ERROR(g_logger) << "should not run"; });
+  iom.schedule([&]() { p.setValue(41); });
+  EAST_ASSERT(f.get() == "42");  //主线程不在调度器中，阻塞等待
+  bool thrown = false;
+  try {
+    g.get();
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  EAST_ASSERT(thrown);
+
+  East::Future<int> broken;
+  {
+    East::Promise<int> q;
+    broken = q.getFuture();
+  }
+  thrown = false;
+  try {
+    broken.get();
+  } catch (const std::logic_error&) {
+    thrown = true;
+  }
+  EAST_ASSERT(thrown);
+  ELOG_INFO(g_logger) << "test_then end";
+}
+
+void test_when_any(East::IOManager& iom) {
+  std::vector<East::Future<int>> futures;
+  for (int i = 3; i > 0; --i) {
+    futures.push_back(East::Async(&iom, [i]() {
+      usleep(i * 50 * 1000);
+      return i;
+    }));
+  }
+  size_t first = East::WhenAny(futures).get();
+  ELOG_INFO(g_logger) << "test_when_any first: " << first;
+  EAST_ASSERT(2 == first);
+  East::WhenAll(futures).wait();
+}
+
+void test_wait_group(East::IOManager& iom) {
+  East::WaitGroup wg;
+  std::atomic<int> count{0};
+  for (int i = 0; i < 100; ++i) {
+    wg.add();
+    iom.schedule([&]() {
+      usleep(1000);
+      ++count;
+      wg.done();
+    });
+  }
+  wg.wait();
+  ELOG_INFO(g_logger) << "test_wait_group count: " << count.load();
+  EAST_ASSERT(100 == count);
+}
+
+//只能移动的可调用对象直接交给调度器
+void test_async_move_only(East::IOManager& iom) {
+  auto p = std::make_unique<int>(21);
+  auto f = East::Async(&iom, [p = std::move(p)]() { return *p * 2; });
+  EAST_ASSERT(42 == f.get());
+  ELOG_INFO(g_logger) << "test_async_move_only end";
+}
+
+int main() {
+  East::IOManager iom(3, false, "future");
+  test_fan_out(iom);
+  test_then(iom);
+  test_when_any(iom);
+  test_wait_group(iom);
+  test_async_move_only(iom);
+  ELOG_INFO(g_logger) << "test future end";
+  return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 21:02:47
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 21:02:47
+ */
+#include <stdlib.h>
+#include <atomic>
+#include <memory>
+#include <new>
+#include "../East/include/Elog.h"
+#include "../East/include/FiberSync.h"
+#include "../East/include/InlineTask.h"
+#include "../East/include/Macro.h"
+#include "../East/include/Scheduler.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+static std::atomic<size_t> g_allocs{0};
+
+void* operator new(size_t n) {
+  ++g_allocs;
+  void* p = malloc(n);
+  if (nullptr == p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+struct Big {
+  char data[128];
+};
+
+//常见大小的捕获放在内部缓冲区，构造和移动都不分配内存
+void test_inline() {
+  int a = 0;
+  int* pa = &a;
+  long b = 1, c = 2, d = 3;
+  size_t before = g_allocs;
+  East::InlineTask t([pa, b, c, d]() { *pa += b + c + d; });
+  East::InlineTask moved(std::move(t));
+  moved();
+  size_t allocs = g_allocs - before;
+  EAST_ASSERT(0 == allocs);
+  EAST_ASSERT(6 == a);
+  EAST_ASSERT(!t && moved && moved.isInline());
+
+  //同样的捕获用std::function需要分配
+  before = g_allocs;
+  std::function<void()> f([pa, b, c, d]() { *pa += b + c + d; });
+  EAST_ASSERT(g_allocs > before);
+  ELOG_INFO(g_logger) << "test_inline end";
+}
+
+//放不下的对象放在堆上，只能移动的捕获也可以
+void test_heap_and_move_only() {
+  Big big{};
+  big.data[0] = 7;
+  int v = 0;
+  East::InlineTask t([big, &v]() { v = big.data[0]; });
+  EAST_ASSERT(!t.isInline());
+  East::InlineTask moved = std::move(t);
+  moved();
+  EAST_ASSERT(7 == v);
+
+  auto p = std::make_unique<int>(42);
+  East::InlineTask u([p = std::move(p), &v]() { v = *p; });
+  u();
+  EAST_ASSERT(42 == v);
+
+  std::function<void()> empty;
+  EAST_ASSERT(nullptr == East::InlineTask(empty));
+  auto lambda = []() {};
+  std::function<void()> wrapped(lambda);
+  EAST_ASSERT(East::InlineTask(wrapped).target_type() == typeid(lambda));
+  ELOG_INFO(g_logger) << "test_heap_and_move_only end";
+}
+
+//调度器直接接受只能移动的回调
+void test_schedule() {
+  East::Scheduler sc(2, false, "inline");
+  sc.start();
+  std::atomic<int> sum{0};
+  East::WaitGroup wg(100);
+  for (int i = 0; i < 100; ++i) {
+    auto p = std::make_unique<int>(i);
+    sc.schedule([p = std::move(p), &sum, &wg]() {
+      sum += *p;
+      wg.done();
+    });
+  }
+  wg.wait();
+  sc.stop();
+  EAST_ASSERT(4950 == sum);
+  ELOG_INFO(g_logger) << "test_schedule end";
+}
+
+int main() {
+  test_inline();
+  test_heap_and_move_only();
+  test_schedule();
+  return 0;
+}
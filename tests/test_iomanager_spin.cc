@@ -0,0 +1,69 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 21:40:05
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 21:40:05
+ */
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include "../East/include/Config.h"
+#include "../East/include/Elog.h"
+#include "../East/include/FiberSync.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+#include "../East/include/util.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+static uint64_t now_us() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+
+//间隔很短的一串任务，记录从提交到开始执行的平均延迟
+static uint64_t burst_latency(uint32_t spin_us) {
+  East::Config::Lookup<uint32_t>("iomanager.spin_us")->setValue(spin_us);
+  East::IOManager iom(2, false, "spin");
+  constexpr int kCount = 200;
+  std::atomic<uint64_t> total{0};
+  for (int i = 0; i < kCount; ++i) {
+    East::WaitGroup wg(1);
+    uint64_t start = now_us();
+    iom.schedule([&]() {
+      total += now_us() - start;
+      wg.done();
+    });
+    wg.wait();
+    usleep(20);
+  }
+  return total / kCount;
+}
+
+//自旋期间插入到最前面的定时器不写管道，阻塞前要重新取超时时间
+void test_timer_while_spinning() {
+  East::Config::Lookup<uint32_t>("iomanager.spin_us")->setValue(1000);
+  East::IOManager iom(2, false, "spin");
+  for (int i = 0; i < 20; ++i) {
+    East::WaitGroup wg(1);
+    uint64_t start = East::GetCurrentTimeInMs();
+    std::atomic<uint64_t> fired{0};
+    iom.addTimer(10, [&]() {
+      fired = East::GetCurrentTimeInMs();
+      wg.done();
+    });
+    wg.wait();
+    EAST_ASSERT(fired - start < 200);
+  }
+  ELOG_INFO(g_logger) << "test_timer_while_spinning end";
+}
+
+int main() {
+  uint64_t no_spin = burst_latency(0);
+  uint64_t spin = burst_latency(200);
+  ELOG_INFO(g_logger) << "avg wakeup latency, no spin: " << no_spin
+                      << "us, spin: " << spin << "us";
+  test_timer_while_spinning();
+  return 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 22:15:36
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 22:15:36
+ */
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <vector>
+#include "../East/include/Config.h"
+#include "../East/include/Elog.h"
+#include "../East/include/FdManager.h"
+#include "../East/include/FiberSync.h"
+#include "../East/include/Hook.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+#include "../East/include/util.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+static void log_stats(const char* name, const East::Scheduler& sc) {
+  auto stats = sc.getWakeupStats();
+  ELOG_INFO(g_logger) << name << ": issued " << stats.issued << ", merged "
+                      << stats.merged << ", useful " << stats.useful
+                      << ", wasted " << stats.wasted;
+}
+
+//所有线程都阻塞时一次提交一批任务，只唤醒一个线程，剩下的由它接力唤醒，不会每个任务唤醒一次
+void test_burst() {
+  East::IOManager iom(4, false, "wakeup");
+  constexpr int kCount = 100;
+  for (int round = 0; round < 5; ++round) {
+    usleep(50 * 1000);  //等所有线程阻塞
+    East::WaitGroup wg(kCount);
+    for (int i = 0; i < kCount; ++i) {
+      iom.schedule([&wg]() { wg.done(); });
+    }
+    wg.wait();
+  }
+  log_stats("test_burst", iom);
+  auto stats = iom.getWakeupStats();
+  EAST_ASSERT(stats.issued > 0 && stats.useful > 0);
+  EAST_ASSERT(stats.issued < 5 * kCount / 2);
+}
+
+//停止时不合并唤醒，所有阻塞的线程都要尽快醒来退出
+void test_stop() {
+  uint64_t start = 0;
+  {
+    East::IOManager iom(4, false, "wakeup");
+    usleep(50 * 1000);
+    start = East::GetCurrentTimeInMs();
+  }
+  uint64_t cost = East::GetCurrentTimeInMs() - start;
+  ELOG_INFO(g_logger) << "test_stop cost: " << cost << "ms";
+  EAST_ASSERT(cost < 200);
+}
+
+//等epoll的线程被定向唤醒去执行一个很长的任务时，另一个阻塞的线程接着等epoll，IO事件不用等它回来
+void test_io_handoff() {
+  East::IOManager iom(2, false, "wakeup");
+  std::vector<int> tids;
+  East::SpinLock lock;
+  for (int i = 0; i < 2; ++i) {
+    iom.schedule([&tids, &lock]() {
+      {
+        East::SpinLock::LockGuard guard(lock);
+        tids.push_back(East::GetThreadId());
+      }
+      //占住这个线程，下一个任务只能由另一个线程执行
+      East::set_hook_enable(false);
+      ::usleep(50 * 1000);
+      East::set_hook_enable(true);
+    });
+    usleep(10 * 1000);
+  }
+  usleep(100 * 1000);
+  EAST_ASSERT(2 == tids.size() && tids[0] != tids[1]);
+
+  //两个线程都阻塞时不知道哪个在等epoll，依次让每个线程去执行长任务
+  for (int tid : tids) {
+    int fds[2];
+    EAST_ASSERT(0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    East::FdMgr::GetInst()->getFd(fds[0], true);  //交给hook管理，读不到数据时挂起协程
+    East::WaitGroup wg(2);
+    std::atomic<uint64_t> read_at{0};
+    iom.schedule([&]() {
+      char c;
+      EAST_ASSERT(1 == read(fds[0], &c, 1));
+      read_at = East::GetCurrentTimeInMs();
+      wg.done();
+    });
+    usleep(50 * 1000);  //等协程挂起、两个线程都阻塞
+    iom.schedule(
+        [&wg]() {
+          East::set_hook_enable(false);
+          ::usleep(300 * 1000);  //阻塞住整个线程
+          East::set_hook_enable(true);
+          wg.done();
+        },
+        tid);
+    usleep(20 * 1000);
+    uint64_t start = East::GetCurrentTimeInMs();
+    EAST_ASSERT(1 == write(fds[1], "x", 1));
+    wg.wait();
+    uint64_t cost = read_at - start;
+    ELOG_INFO(g_logger) << "test_io_handoff cost: " << cost << "ms";
+    EAST_ASSERT(cost < 150);
+    East::FdMgr::GetInst()->deleteFd(fds[0]);
+    close(fds[0]);
+    close(fds[1]);
+  }
+}
+
+int main() {
+  East::Config::Lookup<uint32_t>("iomanager.spin_us")->setValue(0);
+  test_burst();
+  test_stop();
+  test_io_handoff();
+  return 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 07:34:26
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 07:34:26
+ */
+#include <sched.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "../East/include/Elog.h"
+#include "../East/include/Macro.h"
+#include "../East/include/MpmcQueue.h"
+#include "../East/include/Thread.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+//容量向上取整到2的幂，满了之后push返回false且不动传入的值，空了之后pop返回false
+void test_full_empty() {
+  East::MpmcQueue<std::string> q(5);
+  EAST_ASSERT(q.capacity() == 8);
+  for (size_t i = 0; i < q.capacity(); ++i) {
+    std::string v = std::to_string(i);
+    EAST_ASSERT(q.push(std::move(v)));
+  }
+  EAST_ASSERT(q.size() == q.capacity());
+  std::string extra = "extra";
+  EAST_ASSERT(!q.push(std::move(extra)));
+  EAST_ASSERT(extra == "extra");
+
+  std::string v;
+  for (size_t i = 0; i < q.capacity(); ++i) {
+    EAST_ASSERT(q.pop(v) && v == std::to_string(i));
+  }
+  EAST_ASSERT(!q.pop(v) && q.empty());
+}
+
+//入队、出队的位置绕过容量很多圈之后仍然先进先出，每一圈都能重新填满
+void test_wraparound() {
+  East::MpmcQueue<int> q(4);
+  int next_push = 0;
+  int next_pop = 0;
+  int v = 0;
+  for (int round = 0; round < 1000; ++round) {
+    //每次多入一个少出一个，队列里的元素数在0到容量之间来回变化
+    for (int i = 0; i < 3; ++i) {
+      int x = next_push;
+      if (q.push(std::move(x))) {
+        ++next_push;
+      }
+    }
+    for (int i = 0; i < 2; ++i) {
+      if (q.pop(v)) {
+        EAST_ASSERT(v == next_pop++);
+      }
+    }
+    if (q.size() == q.capacity()) {
+      int x = -1;
+      EAST_ASSERT(!q.push(std::move(x)));
+      while (q.pop(v)) {
+        EAST_ASSERT(v == next_pop++);
+      }
+    }
+  }
+  while (q.pop(v)) {
+    EAST_ASSERT(v == next_pop++);
+  }
+  EAST_ASSERT(next_pop == next_push && next_push > 1000);
+}
+
+//N个生产者M个消费者，队列很小，频繁遇到满和空：每个元素恰好被取出一次，
+//同一个生产者的元素被同一个消费者取出时保持入队顺序
+void test_concurrent(size_t producers, size_t consumers) {
+  constexpr int kPerProducer = 100000;
+  const int total = static_cast<int>(producers) * kPerProducer;
+  East::MpmcQueue<int> q(64);
+  std::vector<std::atomic<int>> seen(total);
+  std::atomic<int> popped{0};
+
+  std::vector<East::Thread::sptr> threads;
+  for (size_t p = 0; p < producers; ++p) {
+    threads.push_back(std::make_shared<East::Thread>(
+        "producer_" + std::to_string(p), [&q, p]() {
+          for (int i = 0; i < kPerProducer; ++i) {
+            int v = static_cast<int>(p) * kPerProducer + i;
+            while (!q.push(std::move(v))) {
+              sched_yield();
+            }
+          }
+        }));
+  }
+  for (size_t c = 0; c < consumers; ++c) {
+    threads.push_back(std::make_shared<East::Thread>(
+        "consumer_" + std::to_string(c),
+        [&q, &seen, &popped, producers, total]() {
+          std::vector<int> last(producers, -1);
+          int v = 0;
+          while (popped < total) {
+            if (!q.pop(v)) {
+              sched_yield();
+              continue;
+            }
+            ++popped;
+            ++seen[v];
+            int p = v / kPerProducer;
+            EAST_ASSERT(v > last[p]);
+            last[p] = v;
+          }
+        }));
+  }
+  for (auto& t : threads) {
+    t->join();
+  }
+  EAST_ASSERT(popped == total);
+  for (auto& s : seen) {
+    EAST_ASSERT(s == 1);
+  }
+  EAST_ASSERT(q.empty());
+  ELOG_INFO(g_logger) << producers << " producers, " << consumers
+                      << " consumers: " << total << " elements ok";
+}
+
+int main() {
+  test_full_empty();
+  test_wraparound();
+  test_concurrent(1, 4);
+  test_concurrent(4, 1);
+  test_concurrent(4, 4);
+  return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 22:40:07
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 22:40:07
+ */
+#include <unistd.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include "../East/include/Config.h"
+#include "../East/include/Elog.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+#include "../East/include/Offload.h"
+#include "../East/include/util.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+//阻塞调用放到线程池执行时，同一个IO线程上的其他协程照常运行
+void test_not_blocking(East::IOManager& iom) {
+  East::OffloadPool pool("test_offload", 4, 16);
+  std::atomic<bool> running{true};
+  std::atomic<int> ticks{0};
+  East::WaitGroup wg(5);
+  iom.schedule([&]() {
+    while (running) {
+      usleep(1000);  //hook的usleep，只挂起协程
+      ++ticks;
+    }
+    wg.done();
+  });
+  uint64_t begin = East::GetCurrentTimeInMs();
+  for (int i = 0; i < 4; ++i) {
+    iom.schedule([&, i]() {
+      int v = pool.run([i]() {
+        ::usleep(100 * 1000);  //池里的线程没有hook，真正阻塞
+        return i * 10;
+      });
+      EAST_ASSERT(i * 10 == v);
+      EAST_ASSERT(East::Scheduler::GetThis() == &iom);
+      wg.done();
+    });
+  }
+  //4个调用并行执行，全部挂起的话只需要一次阻塞的时间
+  while (pool.getStats().completed < 4) {
+    usleep(1000);
+  }
+  running = false;
+  wg.wait();
+  uint64_t elapsed = East::GetCurrentTimeInMs() - begin;
+  auto stats = pool.getStats();
+  ELOG_INFO(g_logger) << "test_not_blocking elapsed: " << elapsed
+                      << "ms, ticks: " << ticks.load()
+                      << ", run_us: " << stats.run_us;
+  EAST_ASSERT(elapsed < 300);
+  EAST_ASSERT(ticks > 20);
+  EAST_ASSERT(4 == stats.submitted && 0 == stats.queued);
+  EAST_ASSERT(stats.run_us >= 4 * 100 * 1000);
+}
+
+//排队数达到上限时调用方挂起等待空位
+void test_queue_limit(East::IOManager& iom) {
+  East::OffloadPool pool("test_offload", 1, 2);
+  std::atomic<int> sum{0};
+  East::WaitGroup wg(10);
+  for (int i = 0; i < 10; ++i) {
+    iom.schedule([&, i]() {
+      sum += pool.run([i]() {
+        ::usleep(5 * 1000);
+        return i;
+      });
+      wg.done();
+    });
+  }
+  wg.wait();
+  auto stats = pool.getStats();
+  ELOG_INFO(g_logger) << "test_queue_limit max_queued: " << stats.max_queued
+                      << ", full_waits: " << stats.full_waits
+                      << ", max_wait_us: " << stats.max_wait_us;
+  EAST_ASSERT(45 == sum);
+  EAST_ASSERT(stats.max_queued <= 2);
+  EAST_ASSERT(stats.full_waits > 0);
+  EAST_ASSERT(10 == stats.completed);
+}
+
+//共享栈协程挂起后，同一个线程上的其他共享栈协程会覆盖它的栈，
+//池里的线程执行的必须是移到堆上的可调用对象，不能引用调用方的栈
+void test_shared_stack() {
+  East::Config::Lookup<uint32_t>("fiber.shared_stack_count")->setValue(1);
+  East::IOManager iom(1, false, "offload_shared");
+  East::OffloadPool pool("test_offload", 1, 4);
+  East::WaitGroup wg(3);
+  int sum = 0;
+  //先占住池里唯一的线程，下面的调用要排队，等另一个协程覆盖完栈才执行
+  iom.schedule([&]() {
+    pool.run([]() { ::usleep(50 * 1000); });
+    wg.done();
+  });
+  iom.schedule(
+      [&]() {
+        std::array<int, 64> values;
+        values.fill(7);
+        int res = pool.run([values]() {
+          int s = 0;
+          for (int v : values) {
+            s += v;
+          }
+          return s;
+        });
+        sum = res;
+        wg.done();
+      },
+      -1, true);
+  iom.schedule(
+      [&]() {
+        volatile char buf[32 * 1024];
+        for (size_t i = 0; i < sizeof(buf); ++i) {
+          buf[i] = 0x5a;
+        }
+        wg.done();
+      },
+      -1, true);
+  wg.wait();
+  ELOG_INFO(g_logger) << "test_shared_stack sum: " << sum;
+  EAST_ASSERT(64 * 7 == sum);
+}
+
+//异常在调用方重新抛出，返回值可以只能移动，不在调度器中的线程直接阻塞
+void test_result() {
+  bool thrown = false;
+  try {
+    East::offload([]() { throw std::runtime_error("offload error"); });
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  EAST_ASSERT(thrown);
+
+  std::unique_ptr<int> p = East::offload([]() {
+    return std::unique_ptr<int>(new int(42));
+  });
+  EAST_ASSERT(42 == *p);
+
+  int n = 0;
+  East::offload([&n]() { n = 7; });
+  EAST_ASSERT(7 == n);
+  ELOG_INFO(g_logger) << "test_result end";
+}
+
+int main() {
+  East::IOManager iom(1, false, "offload");
+  test_not_blocking(iom);
+  test_queue_limit(iom);
+  test_shared_stack();
+  test_result();
+  ELOG_INFO(g_logger) << "test offload end";
+  return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-18 00:31:05
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-18 00:31:05
+ */
+#include <unistd.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "../East/include/Config.h"
+#include "../East/include/Elog.h"
+#include "../East/include/FiberSync.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+#include "../East/include/util.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+using Specs = std::map<std::string, std::string>;
+
+static East::ConfigVar<Specs>::sptr g_specs =
+    East::Config::Lookup("scheduler.affinity", Specs{}, "");
+
+static void dump(East::Scheduler& s, const char* tag) {
+  for (auto& p : s.getPlacement()) {
+    ELOG_INFO(g_logger) << tag << " thread " << p.thread_id << " cpus: "
+                        << East::CpuListToString(p.cpus) << ", cpu: " << p.cpu
+                        << ", node: " << p.node;
+  }
+}
+
+//除调用者线程外的所有线程都只允许在cpus上运行
+static bool workers_on(East::Scheduler& s, const std::vector<int>& cpus) {
+  int self = East::GetThreadId();
+  for (auto& p : s.getPlacement()) {
+    if (p.thread_id != self && p.cpus != cpus) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void test_cpu_list() {
+  EAST_ASSERT((std::vector<int>{0, 1, 2, 3, 8}) ==
+              East::ParseCpuList("0-3,8,2"));
+  //保留给出的顺序，worker按顺序分到各个CPU上
+  EAST_ASSERT((std::vector<int>{8, 0, 1, 2, 3}) ==
+              East::ParseCpuList("8,0-3,2"));
+  EAST_ASSERT("0-3,8" == East::CpuListToString({0, 1, 2, 3, 8}));
+  EAST_ASSERT(East::ParseCpuList("a").empty());
+  EAST_ASSERT(East::ParseCpuList("3-1").empty());
+  EAST_ASSERT(East::ParseCpuList("1-2x").empty());
+  EAST_ASSERT(East::ParseCpuList("3abc").empty());
+  EAST_ASSERT(East::ParseCpuList("0-3,5x").empty());
+  EAST_ASSERT(East::ParseCpuList("1-").empty());
+  EAST_ASSERT((std::vector<int>{3}) == East::ParseCpuList("3"));
+  ELOG_INFO(g_logger) << "test_cpu_list end";
+}
+
+void test_affinity() {
+  std::vector<int> allowed = East::GetThreadAffinity(getpid());
+  int first = allowed.front();
+  std::vector<int> node0 = East::GetNumaNodeCpus(0);
+
+  //accept和worker两个IOManager按名称分别放置
+  g_specs->setValue(Specs{{"affinity_accept", std::to_string(first)},
+                          {"affinity_worker", "node:0"}});
+  East::IOManager accept(1, false, "affinity_accept");
+  East::IOManager worker(2, true, "affinity_worker");
+  dump(accept, "accept");
+  dump(worker, "worker");
+  EAST_ASSERT(std::to_string(first) == accept.getAffinity());
+  EAST_ASSERT(workers_on(accept, {first}));
+  if (!node0.empty()) {
+    EAST_ASSERT("node:0" == worker.getAffinity());
+    EAST_ASSERT(workers_on(worker, node0));
+  }
+  //调用者线程不绑定
+  EAST_ASSERT(allowed == East::GetThreadAffinity(0));
+
+  //线程里分配、访问的内存落在线程所在的节点上，这里只检查任务在绑定的CPU上执行
+  East::WaitGroup wg(1);
+  int ran_on = -1;
+  accept.schedule([&]() {
+    ran_on = East::GetThreadCpu(0);
+    wg.done();
+  });
+  wg.wait();
+  EAST_ASSERT(first == ran_on);
+
+  //格式错误或者没有可用的CPU时保持原来的设置
+  EAST_ASSERT(!accept.setAffinity("abc"));
+  EAST_ASSERT(!accept.setAffinity("4000"));
+  EAST_ASSERT(std::to_string(first) == accept.getAffinity());
+
+  //修改配置立即生效，去掉配置后恢复成进程可用的所有CPU
+  g_specs->setValue(Specs{{"affinity_worker", std::to_string(first)}});
+  EAST_ASSERT(accept.getAffinity().empty());
+  EAST_ASSERT(workers_on(accept, allowed));
+  EAST_ASSERT(workers_on(worker, {first}));
+  g_specs->setValue(Specs{});
+  EAST_ASSERT(workers_on(worker, allowed));
+  ELOG_INFO(g_logger) << "test_affinity end";
+}
+
+int main() {
+  test_cpu_list();
+  test_affinity();
+  ELOG_INFO(g_logger) << "test scheduler affinity end";
+  return 0;
+}
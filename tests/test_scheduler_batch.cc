@@ -0,0 +1,68 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 22:41:08
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 22:41:08
+ */
+#include <atomic>
+#include <chrono>
+#include "../East/include/Config.h"
+#include "../East/include/Elog.h"
+#include "../East/include/FiberSync.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+static std::atomic<uint64_t> g_sum{0};
+
+//外部线程提交大量小回调，超出无锁队列容量的部分进溢出链表，批量取出时每个回调都要执行且只执行一次
+static double run(uint32_t batch_size, int count) {
+  East::Config::Lookup<uint32_t>("scheduler.batch_size")->setValue(batch_size);
+  g_sum = 0;
+  East::WaitGroup wg(count);
+  auto begin = std::chrono::steady_clock::now();
+  {
+    East::IOManager iom(4, false, "batch");
+    for (int i = 0; i < count; ++i) {
+      iom.schedule([i, &wg]() {
+        g_sum += i;
+        wg.done();
+      });
+    }
+    wg.wait();
+  }
+  double ms = std::chrono::duration<double, std::milli>(
+                  std::chrono::steady_clock::now() - begin)
+                  .count();
+  EAST_ASSERT(g_sum == static_cast<uint64_t>(count) * (count - 1) / 2);
+  return ms;
+}
+
+//工作线程里提交的任务进本地队列，空闲线程批量偷走，同样每个任务只执行一次
+void test_steal() {
+  constexpr int kCount = 20000;
+  g_sum = 0;
+  East::WaitGroup wg(kCount);
+  East::IOManager iom(4, false, "batch");
+  iom.schedule([&]() {
+    for (int i = 0; i < kCount; ++i) {
+      East::Scheduler::GetThis()->schedule([i, &wg]() {
+        g_sum += i;
+        wg.done();
+      });
+    }
+  });
+  wg.wait();
+  EAST_ASSERT(g_sum == static_cast<uint64_t>(kCount) * (kCount - 1) / 2);
+}
+
+int main() {
+  constexpr int kCount = 100000;
+  double one = run(1, kCount);
+  double batched = run(16, kCount);
+  ELOG_INFO(g_logger) << kCount << " callbacks, batch 1: " << one
+                      << "ms, batch 16: " << batched << "ms";
+  test_steal();
+  return 0;
+}
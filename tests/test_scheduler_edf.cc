@@ -0,0 +1,152 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 16:40:12
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 16:40:12
+ */
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <vector>
+#include "../East/include/Elog.h"
+#include "../East/include/Hook.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+#include "../East/include/Mutex.h"
+#include "../East/include/Scheduler.h"
+#include "../East/include/util.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+//先排队再启动，单个线程按截止时间顺序执行，没有截止时间的任务排在最后
+void test_order() {
+  East::Scheduler sc(1, false, "edf");
+  sc.setEdf(true);
+  std::vector<int> order;
+  East::SpinLock lock;
+  auto record = [&](int v) {
+    return [&, v]() {
+      East::SpinLock::LockGuard guard(lock);
+      order.push_back(v);
+    };
+  };
+  uint64_t now = East::GetCurrentTimeInMs();
+  sc.schedule(record(0));
+  sc.scheduleWithDeadline(record(3), now + 3000);
+  sc.scheduleWithDeadline(record(1), now + 1000);
+  sc.scheduleWithDeadline(record(2), now + 2000);
+  sc.scheduleWithDeadline(record(4), now + 3000);  //截止时间相同按调度顺序
+  sc.start();
+  sc.stop();
+  EAST_ASSERT((order == std::vector<int>{1, 2, 3, 4, 0}));
+  ELOG_INFO(g_logger) << "test_order end";
+}
+
+//过期任务按策略丢弃或者交给回调
+void test_expired() {
+  East::Scheduler sc(1, false, "edf");
+  sc.setEdf(true);
+  std::atomic<int> ran{0};
+  std::atomic<int> expired{0};
+  sc.setExpiredPolicy(East::Scheduler::EXPIRED_CALLBACK,
+                      [&](East::Fiber::sptr, East::InlineTask cb,
+                          uint64_t) {
+                        EAST_ASSERT(cb != nullptr);
+                        ++expired;
+                      });
+  uint64_t now = East::GetCurrentTimeInMs();
+  for (int i = 0; i < 3; ++i) {
+    sc.scheduleWithDeadline([&ran]() { ++ran; }, now - 10);
+  }
+  sc.scheduleWithDeadline([&ran]() { ++ran; }, now + 60 * 1000);
+  sc.start();
+  sc.stop();
+  auto stats = sc.getDeadlineStats();
+  ELOG_INFO(g_logger) << "test_expired scheduled: " << stats.scheduled
+                      << ", expired: " << stats.expired
+                      << ", dropped: " << stats.dropped;
+  EAST_ASSERT(1 == ran && 3 == expired);
+  EAST_ASSERT(4 == stats.scheduled && 3 == stats.expired && 3 == stats.dropped);
+}
+
+//子任务继承父协程的截止时间
+void test_inherit() {
+  East::Scheduler sc(2, false, "edf");
+  sc.setEdf(true);
+  uint64_t deadline = East::GetCurrentTimeInMs() + 60 * 1000;
+  std::atomic<uint64_t> child_deadline{0};
+  sc.scheduleWithDeadline(
+      [&]() {
+        EAST_ASSERT(East::Fiber::CurrentDeadline() == deadline);
+        East::Scheduler::GetThis()->schedule([&]() {
+          child_deadline = East::Fiber::CurrentDeadline();
+        });
+      },
+      deadline);
+  sc.start();
+  sc.stop();
+  EAST_ASSERT(child_deadline == deadline);
+  EAST_ASSERT(2 == sc.getDeadlineStats().scheduled);
+  ELOG_INFO(g_logger) << "test_inherit end";
+}
+
+static uint64_t ProcessCpuMs() {
+  timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//指定线程、带截止时间的任务只由目标线程按截止时间执行，目标线程忙的时候其他线程不会空转
+void test_pinned() {
+  East::IOManager sc(4, false, "edf_pinned");
+  sc.setEdf(true);
+  std::atomic<int> tid{-1};
+  sc.schedule([&]() {
+    tid = East::GetThreadId();
+    //真正阻塞住目标线程
+    East::set_hook_enable(false);
+    ::usleep(300 * 1000);
+    East::set_hook_enable(true);
+  });
+  while (-1 == tid) {
+    ::usleep(1000);
+  }
+  ::usleep(20 * 1000);  //其他线程进入阻塞
+
+  std::vector<int> order;
+  East::SpinLock lock;
+  std::atomic<int> done{0};
+  auto record = [&](int v) {
+    return [&, v]() {
+      EAST_ASSERT(East::GetThreadId() == tid);
+      {
+        East::SpinLock::LockGuard guard(lock);
+        order.push_back(v);
+      }
+      ++done;
+    };
+  };
+  uint64_t cpu_begin = ProcessCpuMs();
+  uint64_t now = East::GetCurrentTimeInMs();
+  sc.schedule(record(0), tid);
+  sc.scheduleWithDeadline(record(2), now + 2000, tid);
+  sc.scheduleWithDeadline(record(1), now + 1000, tid);
+  while (3 != done) {
+    ::usleep(1000);
+  }
+  uint64_t cpu_ms = ProcessCpuMs() - cpu_begin;
+  sc.stop();
+  ELOG_INFO(g_logger) << "test_pinned cpu: " << cpu_ms << "ms";
+  EAST_ASSERT((order == std::vector<int>{1, 2, 0}));
+  EAST_ASSERT(cpu_ms < 100);
+  EAST_ASSERT(2 == sc.getDeadlineStats().scheduled);
+}
+
+int main() {
+  test_order();
+  test_expired();
+  test_inherit();
+  test_pinned();
+  ELOG_INFO(g_logger) << "test scheduler edf end";
+  return 0;
+}
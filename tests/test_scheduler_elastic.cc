@@ -0,0 +1,120 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 23:52:19
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 23:52:19
+ */
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <map>
+#include <vector>
+#include "../East/include/Config.h"
+#include "../East/include/Elog.h"
+#include "../East/include/FiberSync.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+using Ranges = std::map<std::string, std::vector<uint32_t>>;
+
+static East::ConfigVar<Ranges>::sptr g_ranges =
+    East::Config::Lookup("scheduler.elastic_threads", Ranges{}, "");
+
+static uint64_t now_us() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+
+//等条件成立，最多等timeout_ms
+template <class F>
+static bool wait_for(F&& cond, int timeout_ms) {
+  for (int i = 0; i < timeout_ms / 10; ++i) {
+    if (cond()) {
+      return true;
+    }
+    usleep(10 * 1000);
+  }
+  return cond();
+}
+
+//任务排队时增加线程，空闲后减少到下限，按配置实时调整
+void test_grow_and_shrink() {
+  g_ranges->setValue(Ranges{{"elastic", {1, 4}}});
+  East::IOManager iom(1, false, "elastic");
+
+  constexpr int kCount = 400;
+  std::atomic<size_t> max_threads{0};
+  East::WaitGroup wg(kCount);
+  for (int i = 0; i < kCount; ++i) {
+    iom.schedule([&]() {
+      uint64_t end = now_us() + 2000;
+      while (now_us() < end) {
+      }
+      size_t n = iom.getThreadCount();
+      if (n > max_threads) {
+        max_threads = n;
+      }
+      wg.done();
+    });
+  }
+  wg.wait();
+  ELOG_INFO(g_logger) << "max threads under load: " << max_threads;
+  EAST_ASSERT(max_threads > 1);
+
+  EAST_ASSERT(wait_for([&]() { return 1 == iom.getThreadCount(); }, 5000));
+  ELOG_INFO(g_logger) << "threads after idle: " << iom.getThreadCount();
+
+  //修改配置后立即按新的范围调整
+  g_ranges->setValue(Ranges{{"elastic", {3, 3}}});
+  iom.schedule([]() {});
+  EAST_ASSERT(wait_for([&]() { return 3 == iom.getThreadCount(); }, 5000));
+  ELOG_INFO(g_logger) << "threads after config change: "
+                      << iom.getThreadCount();
+}
+
+//退出的线程把指定给它的任务交出去，改为任意线程执行
+void test_hand_off() {
+  g_ranges->setValue(Ranges{{"elastic", {1, 2}}});
+  East::IOManager iom(2, false, "elastic");
+  std::vector<int> tids;
+  East::Mutex mutex;
+  East::WaitGroup wg(20);
+  for (int i = 0; i < 20; ++i) {
+    iom.schedule([&]() {
+      usleep(5 * 1000);
+      {
+        East::Mutex::LockGuard lock(mutex);
+        tids.push_back(East::GetThreadId());
+      }
+      wg.done();
+    });
+  }
+  wg.wait();
+  EAST_ASSERT(wait_for([&]() { return 1 == iom.getThreadCount(); }, 5000));
+
+  //至少有一个线程已经退出，指定给所有用过的线程的任务都要执行
+  std::atomic<int> ran{0};
+  East::WaitGroup wg2(tids.size());
+  for (int tid : tids) {
+    iom.schedule(
+        [&]() {
+          ++ran;
+          wg2.done();
+        },
+        tid);
+  }
+  wg2.wait();
+  EAST_ASSERT(ran == static_cast<int>(tids.size()));
+}
+
+int main() {
+  East::Config::Lookup<uint32_t>("scheduler.elastic_interval_ms")
+      ->setValue(20);
+  test_grow_and_shrink();
+  test_hand_off();
+  g_ranges->setValue(Ranges{});
+  return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 23:20:45
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 23:20:45
+ */
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include "../East/include/Elog.h"
+#include "../East/include/FiberSync.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+static uint64_t now_us() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;
+}
+
+static void busy(uint64_t us) {
+  uint64_t end = now_us() + us;
+  while (now_us() < end) {
+  }
+}
+
+static void log_stats(const East::Scheduler& sc) {
+  for (auto& s : sc.getGroupStats()) {
+    ELOG_INFO(g_logger) << s.name << ": weight " << s.weight << ", depth "
+                        << s.depth << ", scheduled " << s.scheduled
+                        << ", executed " << s.executed << ", wait "
+                        << s.wait_us << "us, max wait " << s.max_wait_us
+                        << "us, run " << s.run_us << "us";
+  }
+}
+
+//两个组都排满任务时，占用的时间和权重成正比
+void test_weighted_share() {
+  East::IOManager iom(1, false, "group");
+  int bulk = iom.addGroup("bulk", 25);
+  constexpr int kCount = 2000;
+  std::atomic<int> normal_done{0};
+  std::atomic<int> bulk_done{0};
+  std::atomic<int> bulk_at_half{-1};
+  East::WaitGroup wg(2 * kCount);
+  //在唯一的工作线程里一次性提交，两个组的任务都排好之后才开始执行
+  iom.schedule([&]() {
+    for (int i = 0; i < kCount; ++i) {
+      iom.schedule([&]() {
+        busy(20);
+        if (kCount / 2 == ++normal_done) {
+          bulk_at_half = bulk_done.load();
+        }
+        wg.done();
+      });
+      iom.scheduleInGroup(
+          [&]() {
+            busy(20);
+            ++bulk_done;
+            wg.done();
+          },
+          bulk);
+    }
+  });
+  wg.wait();
+  log_stats(iom);
+  ELOG_INFO(g_logger) << "bulk tasks done when default reached half: "
+                      << bulk_at_half;
+  //权重100:25，默认组执行1000个时批量组应该执行250个左右
+  EAST_ASSERT(bulk_at_half > 100 && bulk_at_half < 500);
+}
+
+//优先通道不用排在批量任务后面
+void test_priority_lane() {
+  East::IOManager iom(1, false, "group");
+  int bulk = iom.addGroup("bulk", 100);
+  int health = iom.addGroup("health", 1, true);
+  constexpr int kCount = 2000;
+  East::WaitGroup wg(kCount + 1);
+  iom.schedule([&]() {
+    for (int i = 0; i < kCount; ++i) {
+      iom.scheduleInGroup(
+          [&]() {
+            busy(20);
+            wg.done();
+          },
+          bulk);
+    }
+  });
+  usleep(5 * 1000);
+  std::atomic<int> bulk_left{-1};
+  iom.scheduleInGroup(
+      [&]() {
+        bulk_left = iom.getGroupStats()[bulk].depth;
+        wg.done();
+      },
+      health);
+  wg.wait();
+  log_stats(iom);
+  ELOG_INFO(g_logger) << "bulk tasks left when health check ran: "
+                      << bulk_left;
+  EAST_ASSERT(bulk_left > kCount / 2);
+}
+
+//不指定任务组时，子任务和恢复执行的协程留在原来的组里
+void test_inherit() {
+  East::IOManager iom(2, false, "group");
+  int rpc = iom.addGroup("rpc", 100);
+  std::atomic<int> child_group{-1};
+  std::atomic<int> resumed_group{-1};
+  East::WaitGroup wg(2);
+  iom.scheduleInGroup(
+      [&]() {
+        iom.schedule([&]() {
+          child_group = East::Fiber::CurrentGroup();
+          wg.done();
+        });
+        usleep(1000);  //hook住的sleep，协程挂起后由定时器重新调度
+        resumed_group = East::Fiber::CurrentGroup();
+        wg.done();
+      },
+      rpc);
+  wg.wait();
+  EAST_ASSERT(rpc == child_group && rpc == resumed_group);
+  auto stats = iom.getGroupStats();
+  EAST_ASSERT(stats[rpc].scheduled >= 3 && stats[rpc].executed >= 3);
+}
+
+int main() {
+  test_weighted_share();
+  test_priority_lane();
+  test_inherit();
+  return 0;
+}
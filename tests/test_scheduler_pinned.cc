@@ -0,0 +1,80 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 20:10:26
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 20:10:26
+ */
+#include <unistd.h>
+#include <atomic>
+#include "../East/include/Elog.h"
+#include "../East/include/FiberSync.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+#include "../East/include/util.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+static int worker_tid(East::IOManager& iom) {
+  std::atomic<int> tid{-1};
+  East::WaitGroup wg(1);
+  iom.schedule([&]() {
+    tid = East::GetThreadId();
+    wg.done();
+  });
+  wg.wait();
+  return tid;
+}
+
+//所有线程都阻塞在epoll中时，指定线程的任务要唤醒的是目标线程，而不是碰巧读到管道的线程
+void test_wakeup_latency() {
+  East::IOManager iom(4, false, "pinned");
+  int target = worker_tid(iom);
+  uint64_t max_ms = 0;
+  for (int i = 0; i < 50; ++i) {
+    usleep(5 * 1000);  //等所有线程重新进入epoll
+    std::atomic<int> ran_on{-1};
+    East::WaitGroup wg(1);
+    uint64_t start = East::GetCurrentTimeInMs();
+    iom.schedule(
+        [&]() {
+          ran_on = East::GetThreadId();
+          wg.done();
+        },
+        target);
+    wg.wait();
+    max_ms = std::max(max_ms, East::GetCurrentTimeInMs() - start);
+    EAST_ASSERT(ran_on == target);
+  }
+  ELOG_INFO(g_logger) << "pinned wakeup max latency: " << max_ms << "ms";
+  EAST_ASSERT(max_ms < 500);
+}
+
+//工作线程之间大量指定线程的任务，都在目标线程执行
+void test_burst() {
+  East::IOManager iom(4, false, "pinned");
+  int target = worker_tid(iom);
+  constexpr int kCount = 10000;
+  std::atomic<int> wrong{0};
+  East::WaitGroup wg(kCount);
+  iom.schedule([&]() {
+    for (int i = 0; i < kCount; ++i) {
+      East::Scheduler::GetThis()->schedule(
+          [&]() {
+            if (East::GetThreadId() != target) {
+              ++wrong;
+            }
+            wg.done();
+          },
+          target);
+    }
+  });
+  wg.wait();
+  EAST_ASSERT(0 == wrong);
+  ELOG_INFO(g_logger) << "test_burst end";
+}
+
+int main() {
+  test_wakeup_latency();
+  test_burst();
+  return 0;
+}
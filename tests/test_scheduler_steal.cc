@@ -0,0 +1,149 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 07:30:12
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 07:30:12
+ */
+#include <unistd.h>
+#include <atomic>
+#include <vector>
+#include "../East/include/Elog.h"
+#include "../East/include/FiberSync.h"
+#include "../East/include/IOManager.h"
+#include "../East/include/Macro.h"
+#include "../East/include/util.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+static constexpr int kCount = 100;
+
+//工作线程提交的任务进自己的本地队列，自己从尾部取，后提交的先执行
+void test_local_lifo() {
+  std::vector<int> order;
+  East::WaitGroup wg(kCount);
+  East::IOManager iom(1, false, "steal");
+  iom.schedule([&]() {
+    for (int i = 0; i < kCount; ++i) {
+      East::Scheduler::GetThis()->schedule([i, &order, &wg]() {
+        order.push_back(i);
+        wg.done();
+      });
+    }
+  });
+  wg.wait();
+  EAST_ASSERT(order.size() == kCount);
+  for (int i = 0; i < kCount; ++i) {
+    EAST_ASSERT(order[i] == kCount - 1 - i);
+  }
+}
+
+//本地队列的主人被占住时，其他线程从头部偷，按提交顺序执行
+void test_steal_fifo() {
+  std::vector<int> order;
+  std::vector<int> tids;
+  std::atomic<int> done{0};
+  int owner = -1;
+  East::WaitGroup wg(1);
+  East::IOManager iom(2, false, "steal");
+  iom.schedule([&]() {
+    owner = East::GetThreadId();
+    for (int i = 0; i < kCount; ++i) {
+      East::Scheduler::GetThis()->schedule([i, &order, &tids, &done]() {
+        order.push_back(i);
+        tids.push_back(East::GetThreadId());
+        ++done;
+      });
+    }
+    //不让出线程，本地队列里的任务只能被另一个线程偷走
+    uint64_t start = East::GetCurrentTimeInMs();
+    while (done < kCount && East::GetCurrentTimeInMs() - start < 1000) {
+    }
+    wg.done();
+  });
+  wg.wait();
+  EAST_ASSERT(done == kCount);
+  for (int i = 0; i < kCount; ++i) {
+    EAST_ASSERT(order[i] == i);
+    EAST_ASSERT(tids[i] != owner);
+  }
+}
+
+//从外部线程指定到同一个线程的任务经过无锁的inbox，仍然按提交顺序执行
+void test_inbox_order() {
+  std::vector<int> order;
+  std::atomic<bool> started{false};
+  std::atomic<bool> release{false};
+  int target = -1;
+  East::WaitGroup wg(kCount + 1);
+  East::IOManager iom(2, false, "steal");
+  {
+    East::WaitGroup got(1);
+    iom.schedule([&]() {
+      target = East::GetThreadId();
+      got.done();
+    });
+    got.wait();
+  }
+  iom.schedule(
+      [&]() {
+        started = true;
+        while (!release) {
+        }
+        wg.done();
+      },
+      target);
+  while (!started) {
+    usleep(1000);
+  }
+  for (int i = 0; i < kCount; ++i) {
+    iom.schedule(
+        [i, target, &order, &wg]() {
+          EAST_ASSERT(East::GetThreadId() == target);
+          order.push_back(i);
+          wg.done();
+        },
+        target);
+  }
+  release = true;
+  wg.wait();
+  EAST_ASSERT(order.size() == kCount);
+  for (int i = 0; i < kCount; ++i) {
+    EAST_ASSERT(order[i] == i);
+  }
+}
+
+//本地提交、外部提交和指定线程的任务混在一起，互相偷的时候每个任务都只执行一次
+void test_exactly_once() {
+  constexpr int kParents = 200;
+  std::vector<std::atomic<int>> runs(kParents * (kCount + 1));
+  East::WaitGroup wg(kParents * (kCount + 1));
+  East::IOManager iom(4, false, "steal");
+  for (int p = 0; p < kParents; ++p) {
+    iom.schedule([p, &runs, &wg]() {
+      ++runs[p * (kCount + 1)];
+      for (int i = 1; i <= kCount; ++i) {
+        int thread_id = 0 == i % 10 ? East::GetThreadId() : -1;
+        East::Scheduler::GetThis()->schedule(
+            [p, i, &runs, &wg]() {
+              ++runs[p * (kCount + 1) + i];
+              wg.done();
+            },
+            thread_id);
+      }
+      wg.done();
+    });
+  }
+  wg.wait();
+  for (auto& r : runs) {
+    EAST_ASSERT(r == 1);
+  }
+}
+
+int main() {
+  test_local_lifo();
+  test_steal_fifo();
+  test_inbox_order();
+  test_exactly_once();
+  ELOG_INFO(g_logger) << "test scheduler steal end";
+  return 0;
+}
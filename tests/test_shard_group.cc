@@ -0,0 +1,125 @@
+/*
+ * @Author: Xudong0722
+ * @Date: 2026-10-17 23:30:48
+ * @Last Modified by: Xudong0722
+ * @Last Modified time: 2026-10-17 23:30:48
+ */
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <set>
+#include "../East/include/Elog.h"
+#include "../East/include/Macro.h"
+#include "../East/include/ShardGroup.h"
+
+East::Logger::sptr g_logger = ELOG_ROOT();
+
+//回显一次，记录连接是在哪个分片上处理的
+class EchoServer : public East::TcpServer {
+ public:
+  EchoServer(East::IOManager* shard, std::atomic<int>* handled)
+      : East::TcpServer(shard, shard), m_handled(handled) {}
+
+ protected:
+  void handleClient(East::Socket::sptr client) override {
+    char buf[64];
+    int n = client->recv(buf, sizeof(buf));
+    if (n > 0) {
+      buf[0] = '0' + East::ShardGroup::GetCurrentIndex();
+      client->send(buf, n);
+    }
+    ++m_handled[East::ShardGroup::GetCurrentIndex()];
+    client->close();
+  }
+
+ private:
+  std::atomic<int>* m_handled;
+};
+
+void test_message(East::ShardGroup& group) {
+  //不在分片线程上时阻塞等待结果
+  for (size_t i = 0; i < group.size(); ++i) {
+    EAST_ASSERT((int)i ==
+                group.call(i, []() { return East::ShardGroup::GetCurrentIndex(); })
+                    .get());
+  }
+  EAST_ASSERT(-1 == East::ShardGroup::GetCurrentIndex());
+
+  //分片0上的协程调用分片1，挂起后回到分片0继续
+  auto f = group.call(0, [&group]() {
+    int other = group.call(1, []() {
+                       return East::ShardGroup::GetCurrentIndex();
+                     }).get();
+    EAST_ASSERT(&group == East::ShardGroup::GetCurrent());
+    return other * 10 + East::ShardGroup::GetCurrentIndex();
+  });
+  EAST_ASSERT(10 == f.get());
+
+  std::atomic<int> mask{0};
+  group.broadcast([&mask](size_t i) {
+    EAST_ASSERT((int)i == East::ShardGroup::GetCurrentIndex());
+    mask |= 1 << i;
+  }).wait();
+  EAST_ASSERT((1 << group.size()) - 1 == mask);
+  ELOG_INFO(g_logger) << "test_message end";
+}
+
+void test_serve(East::ShardGroup& group) {
+  std::atomic<int> handled[4];
+  for (auto& h : handled) {
+    h = 0;
+  }
+  //端口为0，由内核分配，所有分片都监听分片0分到的那个端口
+  auto addr = East::Address::LookupAny("127.0.0.1:0");
+  EAST_ASSERT(group.serve({addr}, [&handled](East::IOManager* shard) {
+    return std::make_shared<EchoServer>(shard, handled);
+  }));
+  EAST_ASSERT(group.size() == group.getServers().size());
+  uint16_t port = 0;
+  for (auto& server : group.getServers()) {
+    EAST_ASSERT(1 == server->getSocks().size());
+    auto local = std::dynamic_pointer_cast<East::IPAddress>(
+        server->getSocks()[0]->getLocalAddr());
+    EAST_ASSERT(local && 0 != local->getPort());
+    if (0 == port) {
+      port = local->getPort();
+    }
+    EAST_ASSERT(port == local->getPort());
+  }
+
+  //主线程没有hook，用普通的阻塞socket
+  const int kConns = 64;
+  std::set<char> shards;
+  for (int i = 0; i < kConns; ++i) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in sin{};
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(port);
+    sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    EAST_ASSERT(0 == connect(fd, (sockaddr*)&sin, sizeof(sin)));
+    EAST_ASSERT(4 == send(fd, "ping", 4, 0));
+    char buf[8] = {0};
+    EAST_ASSERT(4 == recv(fd, buf, sizeof(buf), MSG_WAITALL));
+    shards.insert(buf[0]);
+    close(fd);
+  }
+  while (handled[0] + handled[1] + handled[2] < kConns) {
+    usleep(1000);
+  }
+  ELOG_INFO(g_logger) << "test_serve handled: " << handled[0].load() << " "
+                      << handled[1].load() << " " << handled[2].load();
+  //内核按四元组的哈希把连接分给各个分片的监听socket
+  EAST_ASSERT(shards.size() > 1);
+}
+
+int main() {
+  East::ShardGroup group(3, "test_shard");
+  EAST_ASSERT(3 == group.size());
+  test_message(group);
+  test_serve(group);
+  group.stop();
+  ELOG_INFO(g_logger) << "test shard group end";
+  return 0;
+}